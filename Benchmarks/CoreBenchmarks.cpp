@@ -0,0 +1,309 @@
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <functional>
+#include <algorithm>
+
+#include "Core/VectorMath.h"
+#include "Core/Projection.h"
+#include "Core/Scene.h"
+#include "Core/Input.h"
+#include "Core/FramePacing.h"
+
+using namespace std;
+
+// Micro-benchmarks of the platform independent core: projection and pose transforms, scene storage, input
+// bookkeeping and frame pacing. Prints a table and optionally writes the results as JSON, so they can be tracked across releases.
+//
+//   CoreBenchmarks [--repetitions N] [--filter TEXT] [--json FILE]
+//
+// --json - writes the JSON to stdout instead of the table.
+
+
+struct CoreBenchmark {
+	const char* name;
+	size_t operations;                      // Per repetition, the reported times are per operation
+	function<float(size_t operations)> run; // Returns a value depending on all results, so nothing is optimized away
+};
+
+struct CoreBenchmarkResult {
+	const char* name;
+	size_t operations;
+	double minNanoseconds;
+	double medianNanoseconds;
+	double meanNanoseconds;
+};
+
+volatile float coreBenchmarkSink;
+
+
+////////////////////////////////////////////////
+// Benchmarks
+////////////////////////////////////////////////
+
+vector<CoreBenchmark> CoreBenchmarks()
+{
+	// Shared inputs, built once and only read by the benchmarks
+	static const vector<Pose> poses = SceneTestPoses(1 << 16);
+	static const size_t poseMask = poses.size() - 1;
+
+	return {
+		// Projection of a view from its fov, once per view and frame
+		{ "ProjectionFromFov", 100000, [](size_t operations) {
+			float sum = 0;
+			Fov fov = sceneTestEyes[0].fov;
+			for (size_t i = 0; i < operations; i++)
+			{
+				fov.angleLeft = sceneTestEyes[0].fov.angleLeft + (float)(i & 15) * 1e-4f;
+				sum += ProjectionFromFov(fov, sceneTestClipNear, sceneTestClipFar).m[0][0];
+			}
+			return sum;
+		} },
+
+		// View projection of a view from its pose and fov, as the frame loop builds it
+		{ "ViewProjectionFromPose", 100000, [](size_t operations) {
+			float sum = 0;
+			const Float4x4 projection = ProjectionFromFov(sceneTestEyes[0].fov, sceneTestClipNear, sceneTestClipFar);
+			for (size_t i = 0; i < operations; i++)
+			{
+				const Float4x4 view = MatrixInverseRigid(MatrixFromPose(poses[i & poseMask], 1.0f));
+				sum += MatrixMultiply(view, projection).m[3][2];
+			}
+			return sum;
+		} },
+
+		// Model matrix of a cube, once per cube and frame
+		{ "MatrixFromPose", 1000000, [](size_t operations) {
+			float sum = 0;
+			for (size_t i = 0; i < operations; i++)
+			{
+				sum += MatrixFromPose(poses[i & poseMask], 0.05f).m[3][0];
+			}
+			return sum;
+		} },
+
+		// Frustum test of a cube's bounding sphere, once per cube, view and frame
+		{ "FrustumIntersectsSphere", 1000000, [](size_t operations) {
+			const Frustum frustum = FrustumFromViewProjection(ProjectionFromFov(sceneTestEyes[0].fov, sceneTestClipNear, sceneTestClipFar));
+			float sum = 0;
+			for (size_t i = 0; i < operations; i++)
+			{
+				sum += FrustumIntersectsSphere(frustum, poses[i & poseMask].position, 0.0866f) ? 1.0f : 0.0f;
+			}
+			return sum;
+		} },
+
+		// Placing cubes into a new scene, including the growth of its storage
+		{ "ScenePlaceCube", 100000, [](size_t operations) {
+			Scene scene;
+			SceneInitialize(scene);
+			for (size_t i = 0; i < operations; i++)
+			{
+				ScenePlaceCube(scene, poses[i & poseMask]);
+			}
+			return (float)ScenePlacedCubeCount(scene);
+		} },
+
+		// Moving the hand cubes, twice per frame
+		{ "SceneSetHandCube", 1000000, [](size_t operations) {
+			Scene scene;
+			SceneInitialize(scene);
+			for (size_t i = 0; i < operations; i++)
+			{
+				SceneSetHandCube(scene, i & 1, poses[i & poseMask]);
+			}
+			return scene.cubes[0].position.x + scene.cubes[1].position.x;
+		} },
+
+		// Adding a 500 Hz input sample to a full hand pose history
+		{ "PoseHistoryAdd", 1000000, [](size_t operations) {
+			PoseHistory history;
+			PoseHistoryInitialize(history, 64);
+			for (size_t i = 0; i < operations; i++)
+			{
+				PoseHistoryAdd(history, (int64_t)i * 2000000, poses[i & poseMask]);
+			}
+			return (float)history.count;
+		} },
+
+		// Hand pose at the moment of a select press, interpolated from a full history
+		{ "PoseHistorySample", 1000000, [](size_t operations) {
+			PoseHistory history;
+			PoseHistoryInitialize(history, 64);
+			for (size_t i = 0; i < 64; i++)
+			{
+				PoseHistoryAdd(history, (int64_t)i * 2000000, poses[i]);
+			}
+
+			float sum = 0;
+			Pose pose;
+			for (size_t i = 0; i < operations; i++)
+			{
+				PoseHistorySample(history, (int64_t)((i * 7919) % (64 * 2000000)), pose);
+				sum += pose.position.x;
+			}
+			return sum;
+		} },
+
+		// Select action state of both hands, once per input sample
+		{ "PressLatchUpdate", 1000000, [](size_t operations) {
+			PressLatch latches[2];
+			float sum = 0;
+			for (size_t i = 0; i < operations; i++)
+			{
+				PressLatch& latch = latches[i & 1];
+				PressLatchUpdate(latch, (i & 6) == 6, (i & 2) != 0, (int64_t)i);
+				if (latch.pressed)
+				{
+					sum += (float)latch.time;
+					latch = {};
+				}
+			}
+			return sum;
+		} },
+
+		// Motion check of the head and both hands and the frame pacing decision, once per frame
+		{ "FramePacingShouldRender", 1000000, [](size_t operations) {
+			FramePacing pacing;
+			float sum = 0;
+			for (size_t i = 0; i < operations; i++)
+			{
+				bool moved = false;
+				for (size_t pose = 0; pose < 4; pose++)
+				{
+					moved = moved || !PoseWithinTolerance(poses[(i + pose) & poseMask], poses[(i + pose + (i & 64)) & poseMask], 0.001f, 0.002f);
+				}
+				sum += FramePacingShouldRender(pacing, moved) ? 1.0f : 0.0f;
+			}
+			return sum;
+		} },
+	};
+}
+
+
+CoreBenchmarkResult CoreBenchmarkRun(const CoreBenchmark& benchmark, uint32_t repetitions)
+{
+	// One untimed run first, so caches and allocations are warm
+	coreBenchmarkSink = benchmark.run(benchmark.operations);
+
+	vector<double> nanoseconds(repetitions);
+	for (double& repetition : nanoseconds)
+	{
+		const auto start = chrono::steady_clock::now();
+		coreBenchmarkSink = benchmark.run(benchmark.operations);
+		repetition = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / benchmark.operations;
+	}
+
+	sort(nanoseconds.begin(), nanoseconds.end());
+
+	CoreBenchmarkResult result = {};
+	result.name = benchmark.name;
+	result.operations = benchmark.operations;
+	result.minNanoseconds = nanoseconds.front();
+	result.medianNanoseconds = nanoseconds[nanoseconds.size() / 2];
+	result.meanNanoseconds = 0;
+	for (double repetition : nanoseconds)
+	{
+		result.meanNanoseconds += repetition / repetitions;
+	}
+	return result;
+}
+
+
+////////////////////////////////////////////////
+// Results
+////////////////////////////////////////////////
+
+void CoreBenchmarkWriteJson(FILE* file, const vector<CoreBenchmarkResult>& results, uint32_t repetitions)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"suite\": \"CoreBenchmarks\",\n");
+	fprintf(file, "  \"schema\": 1,\n");
+	fprintf(file, "  \"repetitions\": %u,\n", repetitions);
+	fprintf(file, "  \"unit\": \"ns_per_operation\",\n");
+	fprintf(file, "  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const CoreBenchmarkResult& result = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"operations\": %zu, \"min\": %.4f, \"median\": %.4f, \"mean\": %.4f }%s\n",
+			result.name, result.operations, result.minNanoseconds, result.medianNanoseconds, result.meanNanoseconds,
+			i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t repetitions = 15;
+	const char* filter = "";
+	const char* jsonPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (!strcmp(argv[i], "--repetitions") && hasValue) repetitions = max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--filter") && hasValue) filter = argv[++i];
+		else if (!strcmp(argv[i], "--json") && hasValue) jsonPath = argv[++i];
+		else
+		{
+			printf("Usage: %s [--repetitions N] [--filter TEXT] [--json FILE]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const bool jsonToStdout = jsonPath != nullptr && !strcmp(jsonPath, "-");
+
+
+	// Run every benchmark whose name contains the filter
+	vector<CoreBenchmarkResult> results;
+	{
+		if (!jsonToStdout)
+		{
+			printf("%-26s %12s %12s %12s  (ns per operation, %u repetitions)\n", "benchmark", "min", "median", "mean", repetitions);
+		}
+
+		for (const CoreBenchmark& benchmark : CoreBenchmarks())
+		{
+			if (strstr(benchmark.name, filter) == nullptr)
+			{
+				continue;
+			}
+
+			results.push_back(CoreBenchmarkRun(benchmark, repetitions));
+			if (!jsonToStdout)
+			{
+				const CoreBenchmarkResult& result = results.back();
+				printf("%-26s %12.3f %12.3f %12.3f\n", result.name, result.minNanoseconds, result.medianNanoseconds, result.meanNanoseconds);
+			}
+		}
+	}
+
+
+	// Machine readable results
+	{
+		if (jsonToStdout)
+		{
+			CoreBenchmarkWriteJson(stdout, results, repetitions);
+		}
+		else if (jsonPath != nullptr)
+		{
+			FILE* file = fopen(jsonPath, "w");
+			if (file == nullptr)
+			{
+				printf("Error: could not write %s\n", jsonPath);
+				return 1;
+			}
+			CoreBenchmarkWriteJson(file, results, repetitions);
+			fclose(file);
+			printf("Wrote %s\n", jsonPath);
+		}
+	}
+
+	return 0;
+}
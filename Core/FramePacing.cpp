@@ -0,0 +1,31 @@
+#include "FramePacing.h"
+
+
+void FramePacingReset(FramePacing& pacing)
+{
+	pacing.stableFrameCount = 0;
+	pacing.skippedFrameCount = 0;
+}
+
+
+bool FramePacingShouldRender(FramePacing& pacing, bool moved)
+{
+	if (moved)
+	{
+		pacing.stableFrameCount = 0;
+	}
+	else if (pacing.stableFrameCount < UINT32_MAX)
+	{
+		pacing.stableFrameCount++;
+	}
+
+	// Full rate while settling, then one rendered frame per interval
+	if (pacing.stableFrameCount <= pacing.settleFrames || pacing.skippedFrameCount + 1 >= pacing.interval)
+	{
+		pacing.skippedFrameCount = 0;
+		return true;
+	}
+
+	pacing.skippedFrameCount++;
+	return false;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Reduced rate rendering for scenes where nothing moves, to save power and heat on long sessions. The app reports
+// every frame whether anything moved since the previous one. Once nothing moved for settleFrames frames only every
+// interval-th frame is rendered, the frames in between submit the last rendered layer again and leave it to the
+// runtime to reproject it to the current head pose. Motion renders the frame it is seen in and returns to full rate
+// until the scene settles again.
+struct FramePacing {
+	uint32_t interval = 2;          // Render every interval-th frame while the scene is stable, 1 always renders
+	uint32_t settleFrames = 30;     // Frames without motion before the rate drops
+	uint32_t stableFrameCount = 0;  // Consecutive frames without motion
+	uint32_t skippedFrameCount = 0; // Frames that submitted the last layer again since it was rendered
+};
+
+
+// Start over at full rate, e.g. when there is no rendered layer to show again
+void FramePacingReset(FramePacing& pacing);
+
+// True if the frame needs to be rendered, false if it can submit the last rendered layer again
+bool FramePacingShouldRender(FramePacing& pacing, bool moved);
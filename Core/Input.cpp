@@ -0,0 +1,105 @@
+#include "Input.h"
+
+
+////////////////////////////////////////////////
+// Pose history
+////////////////////////////////////////////////
+
+const TimedPose& PoseHistoryAt(const PoseHistory& history, size_t index)
+{
+	// index 0 is the oldest sample
+	return history.samples[(history.first + index) % history.samples.size()];
+}
+
+
+void PoseHistoryInitialize(PoseHistory& history, size_t capacity)
+{
+	history.samples.resize(capacity);
+	history.first = 0;
+	history.count = 0;
+}
+
+
+void PoseHistoryAdd(PoseHistory& history, int64_t time, const Pose& pose)
+{
+	const size_t capacity = history.samples.size();
+	if (capacity == 0)
+	{
+		return;
+	}
+
+	if (history.count < capacity)
+	{
+		history.samples[(history.first + history.count) % capacity] = { time, pose };
+		history.count++;
+	}
+	else
+	{
+		history.samples[history.first] = { time, pose };
+		history.first = (history.first + 1) % capacity;
+	}
+}
+
+
+bool PoseHistorySample(const PoseHistory& history, int64_t time, Pose& pose)
+{
+	if (history.count == 0)
+	{
+		return false;
+	}
+
+
+	// Binary search for the first sample after time
+	size_t after = 0;
+	{
+		size_t count = history.count;
+		while (count > 0)
+		{
+			const size_t half = count / 2;
+			if (PoseHistoryAt(history, after + half).time <= time)
+			{
+				after += half + 1;
+				count -= half + 1;
+			}
+			else
+			{
+				count = half;
+			}
+		}
+	}
+
+
+	// Outside of the history, hold the closest sample
+	if (after == 0 || after == history.count)
+	{
+		pose = PoseHistoryAt(history, after == 0 ? 0 : history.count - 1).pose;
+		return true;
+	}
+
+
+	// Interpolate between the samples around time
+	{
+		const TimedPose& a = PoseHistoryAt(history, after - 1);
+		const TimedPose& b = PoseHistoryAt(history, after);
+		const float t = (float)((double)(time - a.time) / (double)(b.time - a.time));
+
+		pose.orientation = QuaternionNlerp(a.pose.orientation, b.pose.orientation, t);
+		pose.position = VectorLerp(a.pose.position, b.pose.position, t);
+	}
+
+	return true;
+}
+
+
+////////////////////////////////////////////////
+// Actions
+////////////////////////////////////////////////
+
+void PressLatchUpdate(PressLatch& latch, bool isDown, bool changedSinceLastSync, int64_t lastChangeTime)
+{
+	if (isDown && changedSinceLastSync)
+	{
+		latch.pressed = true;
+		latch.time = lastChangeTime;
+	}
+}
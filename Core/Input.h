@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "VectorMath.h"
+
+// Bookkeeping of sampled input that does not depend on OpenXR. Times are XrTime values, nanoseconds of the runtime's clock.
+
+struct TimedPose {
+	int64_t time;
+	Pose pose;
+};
+
+// Most recent poses of a tracked object, to find where it was at a moment in the recent past. Ring buffer of samples
+// with non-decreasing times, the oldest is overwritten once it is full
+struct PoseHistory {
+	std::vector<TimedPose> samples;
+	size_t first = 0;
+	size_t count = 0;
+};
+
+// A press of a button action that was seen but not handed on yet, e.g. because the queue to the main thread was full
+struct PressLatch {
+	bool pressed = false;
+	int64_t time = 0; // When the button went down
+};
+
+
+// Empty the history and make room for capacity samples
+void PoseHistoryInitialize(PoseHistory& history, size_t capacity);
+
+void PoseHistoryAdd(PoseHistory& history, int64_t time, const Pose& pose);
+
+// Pose at time, interpolated between the samples around it, or the oldest or newest sample when time is outside of the
+// history. False if the history is empty
+bool PoseHistorySample(const PoseHistory& history, int64_t time, Pose& pose);
+
+
+// Latch a press when the button went down since the last action sync, a newer press replaces one not handed on yet
+void PressLatchUpdate(PressLatch& latch, bool isDown, bool changedSinceLastSync, int64_t lastChangeTime);
@@ -0,0 +1,23 @@
+#include "Projection.h"
+
+
+Float4x4 ProjectionFromFov(const Fov& fov, float clipNear, float clipFar)
+{
+	const float left = clipNear * tanf(fov.angleLeft);
+	const float right = clipNear * tanf(fov.angleRight);
+	const float down = clipNear * tanf(fov.angleDown);
+	const float up = clipNear * tanf(fov.angleUp);
+
+	return MatrixPerspectiveOffCenterRH(left, right, down, up, clipNear, clipFar);
+}
+
+
+Float4x4 ProjectionFromFovFlipY(const Fov& fov, float clipNear, float clipFar)
+{
+	Float4x4 projection = ProjectionFromFov(fov, clipNear, clipFar);
+	for (int row = 0; row < 4; row++)
+	{
+		projection.m[row][1] = -projection.m[row][1];
+	}
+	return projection;
+}
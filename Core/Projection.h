@@ -0,0 +1,18 @@
+#pragma once
+
+#include "VectorMath.h"
+
+// Extent of a view as angles in radians from its forward direction, left and down are negative. Same layout as XrFovf
+struct Fov {
+	float angleLeft;
+	float angleRight;
+	float angleUp;
+	float angleDown;
+};
+
+
+// Perspective projection for D3D style clip space, depth is 0 at clipNear and 1 at clipFar
+Float4x4 ProjectionFromFov(const Fov& fov, float clipNear, float clipFar);
+
+// Same projection for a clip space with Y pointing down, as Vulkan's
+Float4x4 ProjectionFromFovFlipY(const Fov& fov, float clipNear, float clipFar);
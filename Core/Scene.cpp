@@ -0,0 +1,66 @@
+#include "Scene.h"
+
+#include <cmath>
+#include <cstdint>
+
+
+void SceneInitialize(Scene& scene)
+{
+	scene.cubes.assign(sceneHandCubeCount, poseIdentity);
+}
+
+
+void SceneSetHandCube(Scene& scene, size_t handIndex, const Pose& pose)
+{
+	scene.cubes[handIndex] = pose;
+}
+
+
+void ScenePlaceCube(Scene& scene, const Pose& pose)
+{
+	scene.cubes.push_back(pose);
+}
+
+
+size_t ScenePlacedCubeCount(const Scene& scene)
+{
+	return scene.cubes.size() - sceneHandCubeCount;
+}
+
+
+const SceneTestEye sceneTestEyes[sceneTestEyeCount] = {
+	{ { { 0, 0, 0, 1 }, { -0.032f, 0, 0 } }, { -0.70f, 0.62f, 0.55f, -0.60f } },
+	{ { { 0, 0, 0, 1 }, {  0.032f, 0, 0 } }, { -0.62f, 0.70f, 0.55f, -0.60f } },
+};
+
+
+Float4x4 SceneTestViewProjection(size_t eyeIndex)
+{
+	const SceneTestEye& eye = sceneTestEyes[eyeIndex];
+	const Float4x4 projection = ProjectionFromFov(eye.fov, sceneTestClipNear, sceneTestClipFar);
+	const Float4x4 view = MatrixInverseRigid(MatrixFromPose(eye.pose, 1.0f));
+	return MatrixMultiply(view, projection);
+}
+
+
+std::vector<Pose> SceneTestPoses(size_t count)
+{
+	std::vector<Pose> poses(count);
+	uint32_t random = 12345;
+	auto next = [&random]() {
+		random = random * 1664525u + 1013904223u;
+		return (random >> 8) * (1.0f / 16777216.0f);
+	};
+
+	for (Pose& pose : poses)
+	{
+		pose.position = { next() * 3.0f - 1.5f, next() * 2.0f - 1.0f, -0.3f - next() * 4.0f };
+
+		// Random unit quaternion from a random axis and angle
+		const float angle = next() * 6.2831853f;
+		Float3 axis = { next() - 0.5f, next() - 0.5f, next() - 0.5f };
+		const float s = sinf(angle * 0.5f) / (sqrtf(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z) + 1e-6f);
+		pose.orientation = { axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f) };
+	}
+	return poses;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "VectorMath.h"
+#include "Projection.h"
+
+// Cubes of the scene. The first sceneHandCubeCount follow the hands, the ones after them were placed by the user and
+// stay where they were placed
+struct Scene {
+	std::vector<Pose> cubes;
+};
+
+constexpr size_t sceneHandCubeCount = 2;
+
+
+// Hand cubes at the origin and no placed cubes
+void SceneInitialize(Scene& scene);
+
+// Move the cube of a hand, poseIdentity parks it at the origin
+void SceneSetHandCube(Scene& scene, size_t handIndex, const Pose& pose);
+
+void ScenePlaceCube(Scene& scene, const Pose& pose);
+
+size_t ScenePlacedCubeCount(const Scene& scene);
+
+
+// Fixed stereo rig and cube field for the headless renderer, the benchmarks and the tests, so every run on every
+// platform sees the same scene. Roughly a HoloLens 2 like rig, 64mm IPD and slightly asymmetric frustums that are
+// mirrored between the eyes
+struct SceneTestEye {
+	Pose pose;
+	Fov fov;
+};
+
+constexpr size_t sceneTestEyeCount = 2;
+constexpr float sceneTestClipNear = 0.05f;
+constexpr float sceneTestClipFar = 100.0f;
+extern const SceneTestEye sceneTestEyes[sceneTestEyeCount];
+
+// D3D style view projection of a test eye, as the software rasterizer and the D3D11 backend use
+Float4x4 SceneTestViewProjection(size_t eyeIndex);
+
+// Deterministic poses scattered in front of the test rig with random orientations
+std::vector<Pose> SceneTestPoses(size_t count);
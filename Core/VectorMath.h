@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cmath>
+
+// Minimal row-vector matrix math with the same conventions as DirectXMath (v' = v * M), so it can be shared
+// by every render backend and by platforms where DirectXMath is not available.
+// Float3 and Float4 have the same layout as XrVector3f and XrQuaternionf.
+
+struct Float3 {
+	float x, y, z;
+};
+
+struct Float4 {
+	float x, y, z, w;
+};
+
+struct Float4x4 {
+	float m[4][4];
+};
+
+// Same layout as XrPosef
+struct Pose {
+	Float4 orientation;
+	Float3 position;
+};
+
+inline constexpr Pose poseIdentity = { { 0, 0, 0, 1 }, { 0, 0, 0 } };
+
+// Planes a*x + b*y + c*z + d >= 0 of the volume inside of a view projection's clip space
+struct Frustum {
+	Float4 planes[6];
+};
+
+
+inline Float4x4 MatrixIdentity()
+{
+	return { {
+		{ 1, 0, 0, 0 },
+		{ 0, 1, 0, 0 },
+		{ 0, 0, 1, 0 },
+		{ 0, 0, 0, 1 },
+	} };
+}
+
+
+inline Float4x4 MatrixMultiply(const Float4x4& a, const Float4x4& b)
+{
+	Float4x4 result;
+	for (int row = 0; row < 4; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			result.m[row][column] =
+				a.m[row][0] * b.m[0][column] +
+				a.m[row][1] * b.m[1][column] +
+				a.m[row][2] * b.m[2][column] +
+				a.m[row][3] * b.m[3][column];
+		}
+	}
+	return result;
+}
+
+
+inline Float4x4 MatrixTranspose(const Float4x4& a)
+{
+	Float4x4 result;
+	for (int row = 0; row < 4; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			result.m[row][column] = a.m[column][row];
+		}
+	}
+	return result;
+}
+
+
+// Scale, then rotate by a unit quaternion, then translate. Same as XMMatrixAffineTransformation with a zero rotation origin
+inline Float4x4 MatrixAffineTransformation(float scale, const Float4& rotation, const Float3& translation)
+{
+	const float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+
+	return { {
+		{ scale * (1 - 2 * (y * y + z * z)), scale * (2 * (x * y + z * w)),     scale * (2 * (x * z - y * w)),     0 },
+		{ scale * (2 * (x * y - z * w)),     scale * (1 - 2 * (x * x + z * z)), scale * (2 * (y * z + x * w)),     0 },
+		{ scale * (2 * (x * z + y * w)),     scale * (2 * (y * z - x * w)),     scale * (1 - 2 * (x * x + y * y)), 0 },
+		{ translation.x,                     translation.y,                     translation.z,                     1 },
+	} };
+}
+
+
+// Model matrix of a pose, uniformly scaled
+inline Float4x4 MatrixFromPose(const Pose& pose, float scale)
+{
+	return MatrixAffineTransformation(scale, pose.orientation, pose.position);
+}
+
+
+// Inverse of a rotation and translation only matrix, e.g. turning a camera pose into a view matrix
+inline Float4x4 MatrixInverseRigid(const Float4x4& a)
+{
+	Float4x4 result = MatrixIdentity();
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+		{
+			result.m[row][column] = a.m[column][row];
+		}
+	}
+
+	for (int column = 0; column < 3; column++)
+	{
+		result.m[3][column] = -(a.m[3][0] * a.m[column][0] + a.m[3][1] * a.m[column][1] + a.m[3][2] * a.m[column][2]);
+	}
+	return result;
+}
+
+
+// Right handed off center perspective projection mapping depth to [0, 1]. Same as XMMatrixPerspectiveOffCenterRH
+inline Float4x4 MatrixPerspectiveOffCenterRH(float left, float right, float bottom, float top, float nearZ, float farZ)
+{
+	const float reciprocalWidth = 1.0f / (right - left);
+	const float reciprocalHeight = 1.0f / (top - bottom);
+	const float range = farZ / (nearZ - farZ);
+
+	return { {
+		{ 2 * nearZ * reciprocalWidth,        0,                                   0,              0 },
+		{ 0,                                  2 * nearZ * reciprocalHeight,        0,              0 },
+		{ (left + right) * reciprocalWidth,   (top + bottom) * reciprocalHeight,   range,         -1 },
+		{ 0,                                  0,                                   range * nearZ,  0 },
+	} };
+}
+
+
+inline Float3 VectorLerp(const Float3& a, const Float3& b, float t)
+{
+	return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+}
+
+
+// Normalized linear interpolation between unit quaternions along the shorter arc, close enough to a slerp for nearby rotations
+inline Float4 QuaternionNlerp(const Float4& a, const Float4& b, float t)
+{
+	const float sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0 ? -1.0f : 1.0f;
+	Float4 result = {
+		a.x + (sign * b.x - a.x) * t,
+		a.y + (sign * b.y - a.y) * t,
+		a.z + (sign * b.z - a.z) * t,
+		a.w + (sign * b.w - a.w) * t,
+	};
+
+	const float length = sqrtf(result.x * result.x + result.y * result.y + result.z * result.z + result.w * result.w);
+	result.x /= length;
+	result.y /= length;
+	result.z /= length;
+	result.w /= length;
+	return result;
+}
+
+
+// True if b is within maxDistance of a and rotated by at most maxAngle radians against it
+inline bool PoseWithinTolerance(const Pose& a, const Pose& b, float maxDistance, float maxAngle)
+{
+	const float dx = b.position.x - a.position.x;
+	const float dy = b.position.y - a.position.y;
+	const float dz = b.position.z - a.position.z;
+	if (dx * dx + dy * dy + dz * dz > maxDistance * maxDistance)
+	{
+		return false;
+	}
+
+	// The vector part of the relative rotation conj(a) b is sin(angle / 2) times its axis, scaled by the lengths of a and
+	// b. For small angles 2 acos(|a.b|) would compare a dot product a few ulps below 1, where normalization errors of
+	// the runtime's quaternions decide the result
+	const Float4& qa = a.orientation;
+	const Float4& qb = b.orientation;
+	const float x = qa.w * qb.x - qb.w * qa.x - (qa.y * qb.z - qa.z * qb.y);
+	const float y = qa.w * qb.y - qb.w * qa.y - (qa.z * qb.x - qa.x * qb.z);
+	const float z = qa.w * qb.z - qb.w * qa.z - (qa.x * qb.y - qa.y * qb.x);
+	const float lengthsSquared = (qa.x * qa.x + qa.y * qa.y + qa.z * qa.z + qa.w * qa.w) * (qb.x * qb.x + qb.y * qb.y + qb.z * qb.z + qb.w * qb.w);
+	const float sinHalfAngle = sinf(maxAngle * 0.5f);
+	return x * x + y * y + z * z <= sinHalfAngle * sinHalfAngle * lengthsSquared;
+}
+
+
+// Frustum planes of a D3D style clip space (-w <= x, y <= w and 0 <= z <= w) from a row-vector view projection matrix
+inline Frustum FrustumFromViewProjection(const Float4x4& viewProjection)
+{
+	const float(*m)[4] = viewProjection.m;
+	auto column = [&](int c, float sign, int plus) {
+		return Float4{
+			m[0][plus] + sign * m[0][c],
+			m[1][plus] + sign * m[1][c],
+			m[2][plus] + sign * m[2][c],
+			m[3][plus] + sign * m[3][c],
+		};
+	};
+
+	Frustum frustum;
+	frustum.planes[0] = column(0, 1, 3);                           // left
+	frustum.planes[1] = column(0, -1, 3);                          // right
+	frustum.planes[2] = column(1, 1, 3);                           // bottom
+	frustum.planes[3] = column(1, -1, 3);                          // top
+	frustum.planes[4] = { m[0][2], m[1][2], m[2][2], m[3][2] };    // near
+	frustum.planes[5] = column(2, -1, 3);                          // far
+
+	// Normalize so plane distances are in world units and can be compared against a radius
+	for (Float4& plane : frustum.planes)
+	{
+		const float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		plane = { plane.x / length, plane.y / length, plane.z / length, plane.w / length };
+	}
+	return frustum;
+}
+
+
+// Conservative test, true if any part of the sphere may be inside of the frustum
+inline bool FrustumIntersectsSphere(const Frustum& frustum, const Float3& center, float radius)
+{
+	for (const Float4& plane : frustum.planes)
+	{
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// Cube mesh shared by all render backends: position followed by color for every vertex
+inline constexpr float cubeVertices[] =
+{
+	-1.0f, -1.0f, -1.0f,     0.0f, 0.0f, 0.0f,
+	-1.0f, -1.0f,  1.0f,     0.0f, 0.0f, 1.0f,
+	-1.0f,  1.0f, -1.0f,     0.0f, 1.0f, 0.0f,
+	-1.0f,  1.0f,  1.0f,     0.0f, 1.0f, 1.0f,
+	 1.0f, -1.0f, -1.0f,     1.0f, 0.0f, 0.0f,
+	 1.0f, -1.0f,  1.0f,     1.0f, 0.0f, 1.0f,
+	 1.0f,  1.0f, -1.0f,     1.0f, 1.0f, 0.0f,
+	 1.0f,  1.0f,  1.0f,     1.0f, 1.0f, 1.0f,
+};
+
+inline constexpr uint16_t cubeIndices[] =
+{
+	2,1,0, // -x
+	2,3,1,
+
+	6,4,5, // +x
+	6,5,7,
+
+	0,1,5, // -y
+	0,5,4,
+
+	2,6,7, // +y
+	2,7,3,
+
+	0,4,6, // -z
+	0,6,2,
+
+	1,3,7, // +z
+	1,7,5,
+};
+
+inline constexpr uint32_t cubeVertexStride = sizeof(float) * 6;
+inline constexpr uint32_t cubeIndexCount = sizeof(cubeIndices) / sizeof(cubeIndices[0]);
+
+// Scale applied to the unit cube for every hologram
+inline constexpr float cubeScale = 0.05f;
+
+// Radius of a sphere around the unscaled cube, the distance of its corners from the origin
+inline constexpr float cubeBoundingRadius = 1.7320508f;
@@ -0,0 +1,181 @@
+#include "FrameJobs.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+
+void FrameJobsTransform(FrameJobs& frame, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		frame.models[i] = MatrixFromPose(frame.poses[i], frame.scale);
+	}
+}
+
+
+void FrameJobsCull(FrameJobs& frame, size_t view, size_t range)
+{
+	const Frustum& frustum = frame.frustums[view];
+	const float radius = frame.boundingRadius * frame.scale;
+	const size_t begin = range * frameJobsGrainSize;
+	const size_t end = min(frame.poseCount, begin + frameJobsGrainSize);
+
+	vector<uint32_t>& visible = frame.visible[view * frame.rangeCount + range];
+	visible.clear();
+	for (size_t i = begin; i < end; i++)
+	{
+		const Float3 center = { frame.models[i].m[3][0], frame.models[i].m[3][1], frame.models[i].m[3][2] };
+		if (FrustumIntersectsSphere(frustum, center, radius))
+		{
+			visible.push_back((uint32_t)i);
+		}
+	}
+	frame.frustumVisibleCounts[view * frame.rangeCount + range] = (uint32_t)visible.size();
+}
+
+
+void FrameJobsRasterizeOccluders(FrameJobs& frame, size_t view)
+{
+	const auto start = chrono::steady_clock::now();
+
+	// Every cube in the frustum is a candidate, only the closest ones are rasterized
+	OcclusionBuffer& buffer = frame.occlusionBuffers[view];
+	OcclusionBegin(buffer, frame.viewProjections[view]);
+	for (size_t range = 0; range < frame.rangeCount; range++)
+	{
+		const vector<uint32_t>& visible = frame.visible[view * frame.rangeCount + range];
+		OcclusionAddOccluderCandidates(buffer, frame.models.data(), visible.data(), visible.size());
+	}
+	OcclusionRasterizeOccluders(buffer, frame.models.data(), frame.maxOccluders);
+
+	frame.viewStats[view].occluderCount = buffer.occluderCount;
+	frame.viewStats[view].occlusionMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+
+void FrameJobsOcclusionTest(FrameJobs& frame, size_t view, size_t range)
+{
+	const auto start = chrono::steady_clock::now();
+
+	// Drop the hidden cubes from the range's visible list, keeping the scene order
+	const OcclusionBuffer& buffer = frame.occlusionBuffers[view];
+	vector<uint32_t>& visible = frame.visible[view * frame.rangeCount + range];
+	visible.erase(remove_if(visible.begin(), visible.end(), [&frame, &buffer](uint32_t i) {
+		return !OcclusionCubeVisible(buffer, frame.models[i]);
+	}), visible.end());
+
+	frame.occlusionTestMilliseconds[view * frame.rangeCount + range] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+
+void FrameJobsRecord(FrameJobs& frame, size_t view)
+{
+	// Concatenate the ranges in order, so the draw order stays the scene order
+	vector<Float4x4>& drawList = frame.drawLists[view];
+	drawList.clear();
+	for (size_t range = 0; range < frame.rangeCount; range++)
+	{
+		for (uint32_t i : frame.visible[view * frame.rangeCount + range])
+		{
+			drawList.push_back(frame.models[i]);
+		}
+	}
+
+	// Stats of the view, occluder rasterization already filled in its part
+	FrameJobsViewStats& stats = frame.viewStats[view];
+	stats.frustumVisibleCount = 0;
+	for (size_t range = 0; range < frame.rangeCount; range++)
+	{
+		stats.frustumVisibleCount += frame.frustumVisibleCounts[view * frame.rangeCount + range];
+		if (frame.occlusionCulling)
+		{
+			stats.occlusionMilliseconds += frame.occlusionTestMilliseconds[view * frame.rangeCount + range];
+		}
+	}
+	stats.occludedCount = stats.frustumVisibleCount - (uint32_t)drawList.size();
+}
+
+
+void FrameJobsRun(FrameJobs& frame, JobCounter& done)
+{
+	const size_t viewCount = frame.viewProjections.size();
+
+
+	// Size the outputs up front, the jobs only fill them in
+	{
+		frame.rangeCount = (frame.poseCount + frameJobsGrainSize - 1) / frameJobsGrainSize;
+		frame.models.resize(frame.poseCount);
+		frame.drawLists.resize(viewCount);
+		frame.visible.resize(viewCount * frame.rangeCount);
+		frame.frustumVisibleCounts.resize(viewCount * frame.rangeCount);
+		frame.occlusionTestMilliseconds.resize(viewCount * frame.rangeCount);
+		frame.occlusionBuffers.resize(viewCount);
+		frame.viewStats.assign(viewCount, {});
+		frame.frustums.resize(viewCount);
+		for (size_t view = 0; view < viewCount; view++)
+		{
+			frame.frustums[view] = FrustumFromViewProjection(frame.viewProjections[view]);
+		}
+	}
+
+
+	// Pose update, e.g. moving the cubes attached to the hands to their predicted poses
+	{
+		if (frame.updatePoses)
+		{
+			JobRun(frame.posesUpdated, frame.updatePoses);
+		}
+	}
+
+
+	// Model matrix of every cube, in parallel over ranges of the scene
+	{
+		JobRunAfter(frame.posesUpdated, frame.transformed, [&frame]() {
+			JobParallelFor(frame.transformed, frame.poseCount, frameJobsGrainSize, [&frame](size_t begin, size_t end) {
+				FrameJobsTransform(frame, begin, end);
+			});
+		});
+	}
+
+
+	// Frustum culling, in parallel over every range of every view
+	{
+		JobRunAfter(frame.transformed, frame.culled, [&frame, viewCount]() {
+			JobParallelFor(frame.culled, viewCount * frame.rangeCount, 1, [&frame](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+				{
+					FrameJobsCull(frame, i / frame.rangeCount, i % frame.rangeCount);
+				}
+			});
+		});
+	}
+
+
+	// Occluders of each view, then occlusion tests in parallel over every range of every view
+	if (frame.occlusionCulling)
+	{
+		for (size_t view = 0; view < viewCount; view++)
+		{
+			JobRunAfter(frame.culled, frame.occludersRasterized, [&frame, view]() { FrameJobsRasterizeOccluders(frame, view); });
+		}
+
+		JobRunAfter(frame.occludersRasterized, frame.occlusionTested, [&frame, viewCount]() {
+			JobParallelFor(frame.occlusionTested, viewCount * frame.rangeCount, 1, [&frame](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+				{
+					FrameJobsOcclusionTest(frame, i / frame.rangeCount, i % frame.rangeCount);
+				}
+			});
+		});
+	}
+
+
+	// Draw list of each view, the views are recorded in parallel
+	JobCounter& visibleReady = frame.occlusionCulling ? frame.occlusionTested : frame.culled;
+	for (size_t view = 0; view < viewCount; view++)
+	{
+		JobRunAfter(visibleReady, done, [&frame, view]() { FrameJobsRecord(frame, view); });
+	}
+}
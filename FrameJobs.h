@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "JobSystem.h"
+#include "OcclusionCulling.h"
+#include "Core/VectorMath.h"
+
+// Per-frame scene work as a small job graph:
+//
+//   update poses -> transform every cube -> cull every view -> rasterize the occluders of each view
+//                -> occlusion test every view -> record the draw list of each view
+//
+// Transforms, culling and occlusion tests are split into ranges of the scene that run in parallel. The render
+// thread is free to acquire swapchain images meanwhile, it only waits for the draw lists and hands them to the
+// render backend.
+
+struct FrameJobsViewStats {
+	uint32_t frustumVisibleCount = 0; // Cubes inside of the view frustum
+	uint32_t occludedCount = 0;       // Of those, cubes hidden behind the occluders and left out of the draw list
+	uint32_t occluderCount = 0;
+	double occlusionMilliseconds = 0; // CPU time of the view's occlusion stage, rasterization and tests on all threads together
+};
+
+struct FrameJobs {
+	// Inputs, set before FrameJobsRun
+	std::function<void()> updatePoses; // Optional, runs before the poses are read
+	const Pose* poses = nullptr;
+	size_t poseCount = 0;
+	float scale = 1.0f;
+	float boundingRadius = 1.0f;       // Of the unscaled mesh around its origin
+	std::vector<Float4x4> viewProjections;
+	bool occlusionCulling = true;
+	uint32_t maxOccluders = occlusionDefaultOccluderCount; // Per view
+
+	// Outputs, valid once the done counter passed to FrameJobsRun has no pending jobs
+	std::vector<Float4x4> models;
+	std::vector<std::vector<Float4x4>> drawLists; // Model matrices of the cubes visible in each view
+	std::vector<FrameJobsViewStats> viewStats;
+
+	// Stage state
+	std::vector<Frustum> frustums;
+	std::vector<std::vector<uint32_t>> visible;   // Indices of visible cubes for every view and range, [view * rangeCount + range]
+	std::vector<uint32_t> frustumVisibleCounts;   // Of every view and range before the occlusion tests
+	std::vector<double> occlusionTestMilliseconds; // Of every view and range
+	std::vector<OcclusionBuffer> occlusionBuffers; // [view]
+	size_t rangeCount = 0;
+	JobCounter posesUpdated;
+	JobCounter transformed;
+	JobCounter culled;
+	JobCounter occludersRasterized;
+	JobCounter occlusionTested;
+};
+
+// Cubes per transform and cull job
+constexpr size_t frameJobsGrainSize = 1024;
+
+
+// Queue the frame's jobs, done counts them as pending until the draw lists are recorded
+void FrameJobsRun(FrameJobs& frame, JobCounter& done);
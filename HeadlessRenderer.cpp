@@ -0,0 +1,300 @@
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "SoftwareRasterizer.h"
+#include "OcclusionCulling.h"
+#include "JobSystem.h"
+#include "CubeMesh.h"
+#include "Core/Scene.h"
+
+using namespace std;
+
+// Renders the cube scene for both eyes of a fixed stereo rig with the software rasterizer, without an OpenXR
+// runtime or a GPU. Compares the images against golden images to catch rendering regressions and reports
+// throughput to catch performance regressions.
+//
+//   HeadlessRenderer [--instances N] [--frames N] [--width W] [--height H] [--threads N] [--occlusion]
+//                    [--golden DIRECTORY] [--update-golden]
+//
+// --occlusion leaves out the cubes OcclusionCulling finds hidden, the images must still match the same golden images.
+
+
+// Allow a few pixels to differ by more than rounding, float results vary slightly between SSE2, NEON and scalar builds
+const float goldenMaxMismatchFraction = 0.001f;
+const int goldenChannelTolerance = 2;
+
+
+////////////////////////////////////////////////
+// Golden images
+////////////////////////////////////////////////
+
+bool HeadlessWritePpm(const string& path, const SoftwareRenderTarget& target)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		printf("Failed to write %s\n", path.c_str());
+		return false;
+	}
+
+	fprintf(file, "P6\n%d %d\n255\n", target.width, target.height);
+	vector<uint8_t> row(target.width * 3);
+	for (int32_t y = 0; y < target.height; y++)
+	{
+		for (int32_t x = 0; x < target.width; x++)
+		{
+			const uint32_t pixel = target.color[(size_t)y * target.stride + x];
+			row[x * 3 + 0] = (uint8_t)(pixel);
+			row[x * 3 + 1] = (uint8_t)(pixel >> 8);
+			row[x * 3 + 2] = (uint8_t)(pixel >> 16);
+		}
+		fwrite(row.data(), 1, row.size(), file);
+	}
+	fclose(file);
+	return true;
+}
+
+
+bool HeadlessReadPpm(const string& path, int32_t& width, int32_t& height, vector<uint8_t>& pixels)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file)
+	{
+		printf("Failed to read %s, run with --update-golden to create it\n", path.c_str());
+		return false;
+	}
+
+	int maxValue = 0;
+	const bool valid = fscanf(file, "P6 %d %d %d", &width, &height, &maxValue) == 3 && maxValue == 255 && fgetc(file) != EOF;
+	if (valid)
+	{
+		pixels.resize((size_t)width * height * 3);
+	}
+	const bool complete = valid && fread(pixels.data(), 1, pixels.size(), file) == pixels.size();
+	fclose(file);
+
+	if (!complete)
+	{
+		printf("%s is not a binary PPM image\n", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+bool HeadlessCompareGolden(const string& path, const SoftwareRenderTarget& target)
+{
+	int32_t width, height;
+	vector<uint8_t> golden;
+	if (!HeadlessReadPpm(path, width, height, golden))
+		return false;
+
+	if (width != target.width || height != target.height)
+	{
+		printf("%s is %dx%d, rendered %dx%d\n", path.c_str(), width, height, target.width, target.height);
+		return false;
+	}
+
+	size_t mismatches = 0;
+	for (int32_t y = 0; y < height; y++)
+	{
+		for (int32_t x = 0; x < width; x++)
+		{
+			const uint32_t pixel = target.color[(size_t)y * target.stride + x];
+			const uint8_t* expected = &golden[((size_t)y * width + x) * 3];
+			for (int channel = 0; channel < 3; channel++)
+			{
+				if (abs((int)((pixel >> (channel * 8)) & 0xFF) - (int)expected[channel]) > goldenChannelTolerance)
+				{
+					mismatches++;
+					break;
+				}
+			}
+		}
+	}
+
+	const float fraction = (float)mismatches / ((float)width * height);
+	const bool passed = fraction <= goldenMaxMismatchFraction;
+	printf("%s: %zu pixels differ (%.4f%%), %s\n", path.c_str(), mismatches, fraction * 100, passed ? "passed" : "FAILED");
+	return passed;
+}
+
+
+////////////////////////////////////////////////
+// Main
+////////////////////////////////////////////////
+
+int main(int argc, char** argv)
+{
+	uint32_t instanceCount = 10000;
+	uint32_t frameCount = 20;
+	uint32_t threadCount = 0;
+	int32_t width = 1440;
+	int32_t height = 936;
+	string goldenDirectory;
+	bool updateGolden = false;
+	bool occlusion = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (!strcmp(argv[i], "--instances") && hasValue) instanceCount = (uint32_t)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--frames") && hasValue) frameCount = (uint32_t)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--threads") && hasValue) threadCount = (uint32_t)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--width") && hasValue) width = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--height") && hasValue) height = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--golden") && hasValue) goldenDirectory = argv[++i];
+		else if (!strcmp(argv[i], "--update-golden")) updateGolden = true;
+		else if (!strcmp(argv[i], "--occlusion")) occlusion = true;
+		else
+		{
+			printf("Usage: %s [--instances N] [--frames N] [--width W] [--height H] [--threads N] [--occlusion] [--golden DIRECTORY] [--update-golden]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (width <= 0 || height <= 0 || frameCount == 0)
+	{
+		printf("Width, height and frame count need to be positive\n");
+		return 1;
+	}
+
+
+	// Scene, stereo rig and one in-memory target per eye in place of the swapchain images
+	vector<Float4x4> models;
+	for (const Pose& pose : SceneTestPoses(instanceCount))
+	{
+		models.push_back(MatrixFromPose(pose, cubeScale));
+	}
+	const SoftwareMesh mesh = { cubeVertices, (uint32_t)(sizeof(cubeVertices) / cubeVertexStride), cubeIndices, cubeIndexCount };
+
+	JobSystemInitialize(threadCount);
+	SoftwareRasterizer rasterizer;
+	SoftwareRasterizerInitialize(rasterizer);
+
+	SoftwareRenderTarget targets[2];
+	Float4x4 viewProjections[2];
+	for (int eye = 0; eye < 2; eye++)
+	{
+		SoftwareCreateRenderTarget(targets[eye], width, height);
+		viewProjections[eye] = SceneTestViewProjection(eye);
+	}
+
+	// Occluder candidates are the cubes in the view frustum, as in FrameJobs
+	OcclusionBuffer occlusionBuffer;
+	vector<uint32_t> occluderCandidates[2];
+	for (int eye = 0; eye < 2; eye++)
+	{
+		const Frustum frustum = FrustumFromViewProjection(viewProjections[eye]);
+		for (uint32_t i = 0; i < instanceCount; i++)
+		{
+			const Float3 center = { models[i].m[3][0], models[i].m[3][1], models[i].m[3][2] };
+			if (FrustumIntersectsSphere(frustum, center, cubeBoundingRadius * cubeScale))
+			{
+				occluderCandidates[eye].push_back(i);
+			}
+		}
+	}
+	vector<Float4x4> unoccludedModels;
+	uint64_t occludedCount = 0;
+	double occlusionSeconds = 0;
+
+	printf("Rendering %u cubes at %dx%d per eye for %u frames on %u threads%s\n", instanceCount, width, height, frameCount, JobSystemThreadCount(), occlusion ? " with occlusion culling" : "");
+
+
+	// Render frames the same way OpenXRRenderFrame does, clear and draw every view. The first frame warms up the bins.
+	auto renderFrame = [&]() {
+		SoftwareRasterizerStats frameStats;
+		for (int eye = 0; eye < 2; eye++)
+		{
+			// Occluders, then only the cubes they do not hide
+			const vector<Float4x4>* drawModels = &models;
+			if (occlusion)
+			{
+				const auto occlusionStart = chrono::steady_clock::now();
+				OcclusionBegin(occlusionBuffer, viewProjections[eye]);
+				OcclusionAddOccluderCandidates(occlusionBuffer, models.data(), occluderCandidates[eye].data(), occluderCandidates[eye].size());
+				OcclusionRasterizeOccluders(occlusionBuffer, models.data(), occlusionDefaultOccluderCount);
+
+				unoccludedModels.clear();
+				for (const Float4x4& model : models)
+				{
+					if (OcclusionCubeVisible(occlusionBuffer, model))
+					{
+						unoccludedModels.push_back(model);
+					}
+				}
+				drawModels = &unoccludedModels;
+				occludedCount += models.size() - unoccludedModels.size();
+				occlusionSeconds += chrono::duration<double>(chrono::steady_clock::now() - occlusionStart).count();
+			}
+
+			const float clear[] = { 0, 0, 0, 1 };
+			SoftwareClear(targets[eye], clear, 1.0f);
+			const SoftwareRasterizerStats stats = SoftwareDrawInstances(rasterizer, targets[eye], mesh, viewProjections[eye], *drawModels);
+			frameStats.trianglesSubmitted += stats.trianglesSubmitted;
+			frameStats.trianglesRasterized += stats.trianglesRasterized;
+			frameStats.pixelsCovered += stats.pixelsCovered;
+			frameStats.pixelsWritten += stats.pixelsWritten;
+		}
+		return frameStats;
+	};
+
+	renderFrame();
+	occludedCount = 0;
+	occlusionSeconds = 0;
+
+	SoftwareRasterizerStats totals;
+	const auto start = chrono::steady_clock::now();
+	for (uint32_t frame = 0; frame < frameCount; frame++)
+	{
+		const SoftwareRasterizerStats stats = renderFrame();
+		totals.trianglesSubmitted += stats.trianglesSubmitted;
+		totals.trianglesRasterized += stats.trianglesRasterized;
+		totals.pixelsCovered += stats.pixelsCovered;
+		totals.pixelsWritten += stats.pixelsWritten;
+	}
+	const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+
+	// Throughput report
+	printf("Frame time:           %8.3f ms (both eyes)\n", seconds * 1000 / frameCount);
+	printf("Triangles submitted:  %8.2f M/s (%llu per frame)\n", totals.trianglesSubmitted / seconds / 1e6, (unsigned long long)(totals.trianglesSubmitted / frameCount));
+	printf("Triangles rasterized: %8.2f M/s (%llu per frame)\n", totals.trianglesRasterized / seconds / 1e6, (unsigned long long)(totals.trianglesRasterized / frameCount));
+	printf("Pixels rasterized:    %8.2f M/s (%llu per frame)\n", totals.pixelsCovered / seconds / 1e6, (unsigned long long)(totals.pixelsCovered / frameCount));
+	printf("Pixels written:       %8.2f M/s (%llu per frame)\n", totals.pixelsWritten / seconds / 1e6, (unsigned long long)(totals.pixelsWritten / frameCount));
+	if (occlusion)
+	{
+		printf("Occlusion culling:    %8.3f ms (both eyes), %llu of %u cubes occluded per frame, %u occluders in the last view\n",
+			occlusionSeconds * 1000 / frameCount, (unsigned long long)(occludedCount / frameCount), instanceCount * 2, occlusionBuffer.occluderCount);
+	}
+
+
+	// Golden images, one per eye and per configuration
+	bool passed = true;
+	if (!goldenDirectory.empty())
+	{
+		for (int eye = 0; eye < 2; eye++)
+		{
+			const string path = goldenDirectory + "/HeadlessEye" + to_string(eye) + "_" + to_string(width) + "x" + to_string(height) + "_" + to_string(instanceCount) + ".ppm";
+			if (updateGolden)
+			{
+				if (HeadlessWritePpm(path, targets[eye]))
+					printf("Wrote %s\n", path.c_str());
+				else
+					passed = false;
+			}
+			else
+			{
+				passed = HeadlessCompareGolden(path, targets[eye]) && passed;
+			}
+		}
+	}
+
+	JobSystemShutdown();
+	return passed ? 0 : 1;
+}
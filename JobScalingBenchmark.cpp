@@ -0,0 +1,162 @@
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+
+#include "JobSystem.h"
+#include "FrameJobs.h"
+#include "SoftwareRasterizer.h"
+#include "CubeMesh.h"
+#include "Core/Scene.h"
+
+using namespace std;
+
+// Runs the per-frame scene jobs and the software rasterizer on 1 to N job threads and reports how they scale.
+//
+//   JobScalingBenchmark [--max-threads N] [--cubes N] [--instances N] [--iterations N] [--no-occlusion]
+
+
+struct BenchmarkResult {
+	double frameJobsMilliseconds;
+	double rasterizerMilliseconds;
+	FrameJobsViewStats occlusionStats; // Of the last frame, both views together
+};
+
+
+template<typename Work>
+double BenchmarkMilliseconds(uint32_t iterations, const Work& work)
+{
+	// One untimed run first so allocations and thread start up are not measured
+	work();
+
+	const auto start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		work();
+	}
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / iterations;
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t maxThreads = max(1u, thread::hardware_concurrency());
+	uint32_t cubeCount = 200000;
+	uint32_t instanceCount = 10000;
+	uint32_t iterations = 10;
+	bool occlusion = true;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (!strcmp(argv[i], "--max-threads") && hasValue) maxThreads = max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--cubes") && hasValue) cubeCount = (uint32_t)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--instances") && hasValue) instanceCount = (uint32_t)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--iterations") && hasValue) iterations = max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--no-occlusion")) occlusion = false;
+		else
+		{
+			printf("Usage: %s [--max-threads N] [--cubes N] [--instances N] [--iterations N] [--no-occlusion]\n", argv[0]);
+			return 1;
+		}
+	}
+
+
+	// Scene for the frame jobs and a smaller one for the rasterizer, which does far more work per cube
+	const vector<Pose> poses = SceneTestPoses(cubeCount);
+	const vector<Float4x4> viewProjections = { SceneTestViewProjection(0), SceneTestViewProjection(1) };
+
+	vector<Float4x4> instanceModels;
+	for (const Pose& pose : SceneTestPoses(instanceCount))
+	{
+		instanceModels.push_back(MatrixFromPose(pose, cubeScale));
+	}
+	const SoftwareMesh mesh = { cubeVertices, (uint32_t)(sizeof(cubeVertices) / cubeVertexStride), cubeIndices, cubeIndexCount };
+
+	printf("Frame jobs: %u cubes, 2 views, occlusion culling %s. Rasterizer: %u cubes, 2 eyes at 1440x936. %u iterations per thread count\n",
+		cubeCount, occlusion ? "on" : "off", instanceCount, iterations);
+	printf("%8s %14s %8s %10s %14s %8s %10s %12s %12s\n", "threads", "frame jobs ms", "speedup", "efficiency", "rasterizer ms", "speedup", "efficiency", "occluded", "occlusion ms");
+
+
+	vector<BenchmarkResult> results;
+	for (uint32_t threadCount = 1; threadCount <= maxThreads; threadCount++)
+	{
+		JobSystemInitialize(threadCount);
+		BenchmarkResult result;
+
+
+		// Pose update, transforms, culling and draw list recording for both views, as every frame of the app does
+		{
+			FrameJobs frame;
+			frame.poses = poses.data();
+			frame.poseCount = poses.size();
+			frame.scale = cubeScale;
+			frame.boundingRadius = cubeBoundingRadius;
+			frame.viewProjections = viewProjections;
+			frame.occlusionCulling = occlusion;
+
+			result.frameJobsMilliseconds = BenchmarkMilliseconds(iterations, [&]() {
+				JobCounter done;
+				FrameJobsRun(frame, done);
+				JobWait(done);
+			});
+
+			result.occlusionStats = {};
+			for (const FrameJobsViewStats& viewStats : frame.viewStats)
+			{
+				result.occlusionStats.frustumVisibleCount += viewStats.frustumVisibleCount;
+				result.occlusionStats.occludedCount += viewStats.occludedCount;
+				result.occlusionStats.occluderCount += viewStats.occluderCount;
+				result.occlusionStats.occlusionMilliseconds += viewStats.occlusionMilliseconds;
+			}
+		}
+
+
+		// Both eyes with the software rasterizer
+		{
+			SoftwareRasterizer rasterizer;
+			SoftwareRasterizerInitialize(rasterizer);
+			SoftwareRenderTarget target;
+			SoftwareCreateRenderTarget(target, 1440, 936);
+
+			result.rasterizerMilliseconds = BenchmarkMilliseconds(iterations, [&]() {
+				for (const Float4x4& viewProjection : viewProjections)
+				{
+					const float clear[] = { 0, 0, 0, 1 };
+					SoftwareClear(target, clear, 1.0f);
+					SoftwareDrawInstances(rasterizer, target, mesh, viewProjection, instanceModels);
+				}
+			});
+		}
+
+		JobSystemShutdown();
+		results.push_back(result);
+
+
+		// Speedup relative to a single thread, efficiency is the speedup per thread. Occlusion is the share of the cubes
+		// in the view frustums that occlusion culling removed and the CPU time of its stage, summed over the threads
+		{
+			const double frameJobsSpeedup = results[0].frameJobsMilliseconds / result.frameJobsMilliseconds;
+			const double rasterizerSpeedup = results[0].rasterizerMilliseconds / result.rasterizerMilliseconds;
+			const FrameJobsViewStats& occlusionStats = result.occlusionStats;
+			printf("%8u %14.3f %7.2fx %9.0f%% %14.3f %7.2fx %9.0f%% %11.1f%% %12.3f\n", threadCount,
+				result.frameJobsMilliseconds, frameJobsSpeedup, frameJobsSpeedup / threadCount * 100,
+				result.rasterizerMilliseconds, rasterizerSpeedup, rasterizerSpeedup / threadCount * 100,
+				occlusionStats.frustumVisibleCount > 0 ? occlusionStats.occludedCount * 100.0 / occlusionStats.frustumVisibleCount : 0.0,
+				occlusionStats.occlusionMilliseconds);
+		}
+	}
+
+	if (occlusion && !results.empty())
+	{
+		const FrameJobsViewStats& occlusionStats = results.back().occlusionStats;
+		printf("Occlusion culling: %u of %u cubes in the view frustums occluded by %u occluders, both views together\n",
+			occlusionStats.occludedCount, occlusionStats.frustumVisibleCount, occlusionStats.occluderCount);
+	}
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+#include "JobSystem.h"
+
+#include <thread>
+#include <deque>
+#include <memory>
+#include <condition_variable>
+#include <algorithm>
+
+using namespace std;
+
+
+struct JobQueue {
+	mutex jobsMutex;
+	deque<Job> jobs;
+};
+
+vector<unique_ptr<JobQueue>> jobQueues;
+vector<thread> jobThreads;
+
+// Sleeping workers are only woken up when there is work, pushes check jobSleepingCount to skip the lock otherwise
+atomic<int32_t> jobQueuedCount(0);
+atomic<int32_t> jobSleepingCount(0);
+mutex jobSleepMutex;
+condition_variable jobSleepCondition;
+bool jobShutdown = false;
+
+// Threads that are not job threads (e.g. the input thread) share the deque of thread 0
+thread_local uint32_t jobThreadIndex = 0;
+
+
+////////////////////////////////////////////////
+// Scheduling
+////////////////////////////////////////////////
+
+void JobPush(Job job)
+{
+	{
+		JobQueue& queue = *jobQueues[jobThreadIndex];
+		lock_guard<mutex> lock(queue.jobsMutex);
+		queue.jobs.push_back(move(job));
+	}
+
+	jobQueuedCount++;
+	if (jobSleepingCount > 0)
+	{
+		lock_guard<mutex> lock(jobSleepMutex);
+		jobSleepCondition.notify_one();
+	}
+}
+
+
+bool JobTryGet(Job& job)
+{
+	const uint32_t threadCount = (uint32_t)jobQueues.size();
+
+	// Newest job of our own first, it is the most likely to still be in cache, then the oldest job of another thread
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		const bool own = i == 0;
+		JobQueue& queue = *jobQueues[(jobThreadIndex + i) % threadCount];
+		lock_guard<mutex> lock(queue.jobsMutex);
+		if (queue.jobs.empty())
+		{
+			continue;
+		}
+
+		if (own)
+		{
+			job = move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+		else
+		{
+			job = move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+		jobQueuedCount--;
+		return true;
+	}
+
+	return false;
+}
+
+
+void JobFinish(JobCounter& counter)
+{
+	// The counter's mutex is held until the counter is no longer touched, JobWait takes it before returning so
+	// the counter can be destroyed as soon as the wait is over
+	vector<Job> continuations;
+	{
+		lock_guard<mutex> lock(counter.continuationsMutex);
+		if (--counter.pending == 0)
+		{
+			continuations.swap(counter.continuations);
+		}
+	}
+
+	for (Job& continuation : continuations)
+	{
+		JobPush(move(continuation));
+	}
+}
+
+
+void JobExecute(Job& job)
+{
+	job.work();
+	if (job.counter != nullptr)
+	{
+		JobFinish(*job.counter);
+	}
+}
+
+
+void JobWorkerRun(uint32_t threadIndex)
+{
+	jobThreadIndex = threadIndex;
+
+	for (;;)
+	{
+		Job job;
+		if (JobTryGet(job))
+		{
+			JobExecute(job);
+			continue;
+		}
+
+		unique_lock<mutex> lock(jobSleepMutex);
+		jobSleepingCount++;
+		jobSleepCondition.wait(lock, []() { return jobShutdown || jobQueuedCount > 0; });
+		jobSleepingCount--;
+		if (jobShutdown)
+		{
+			return;
+		}
+	}
+}
+
+
+////////////////////////////////////////////////
+// Job system
+////////////////////////////////////////////////
+
+void JobSystemInitialize(uint32_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = max(1u, thread::hardware_concurrency());
+	}
+
+	jobShutdown = false;
+	jobThreadIndex = 0;
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		jobQueues.push_back(make_unique<JobQueue>());
+	}
+
+	for (uint32_t i = 1; i < threadCount; i++)
+	{
+		jobThreads.emplace_back(JobWorkerRun, i);
+	}
+}
+
+
+void JobSystemShutdown()
+{
+	{
+		lock_guard<mutex> lock(jobSleepMutex);
+		jobShutdown = true;
+		jobSleepCondition.notify_all();
+	}
+
+	for (thread& jobThread : jobThreads)
+	{
+		jobThread.join();
+	}
+
+	jobThreads.clear();
+	jobQueues.clear();
+	jobQueuedCount = 0;
+}
+
+
+uint32_t JobSystemThreadCount()
+{
+	return (uint32_t)jobQueues.size();
+}
+
+
+void JobRun(JobCounter& counter, function<void()> work)
+{
+	counter.pending++;
+	JobPush({ move(work), &counter });
+}
+
+
+void JobRunAfter(JobCounter& dependency, JobCounter& counter, function<void()> work)
+{
+	counter.pending++;
+
+	{
+		lock_guard<mutex> lock(dependency.continuationsMutex);
+		if (dependency.pending > 0)
+		{
+			dependency.continuations.push_back({ move(work), &counter });
+			return;
+		}
+	}
+
+	JobPush({ move(work), &counter });
+}
+
+
+void JobParallelFor(JobCounter& counter, size_t count, size_t grainSize, function<void(size_t begin, size_t end)> work)
+{
+	grainSize = max<size_t>(grainSize, 1);
+
+	// Ranges share the work function instead of copying it for every job
+	auto shared = make_shared<function<void(size_t, size_t)>>(move(work));
+	for (size_t begin = 0; begin < count; begin += grainSize)
+	{
+		const size_t end = min(count, begin + grainSize);
+		JobRun(counter, [shared, begin, end]() { (*shared)(begin, end); });
+	}
+}
+
+
+void JobWait(JobCounter& counter)
+{
+	while (counter.pending > 0)
+	{
+		Job job;
+		if (JobTryGet(job))
+		{
+			JobExecute(job);
+		}
+		else
+		{
+			this_thread::yield();
+		}
+	}
+
+	// Let the thread that finished the last job release the counter
+	lock_guard<mutex> lock(counter.continuationsMutex);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Fixed size work-stealing job scheduler. Every thread owns a deque: it pushes and pops its own jobs at the back
+// and idle threads steal from the front of the others'. The thread that initializes the job system is thread 0
+// and takes part in the work while it waits for a counter, so a single thread setup runs everything inline.
+
+struct JobCounter;
+
+struct Job {
+	std::function<void()> work;
+	JobCounter* counter; // Finished one more job once work returns
+};
+
+// Number of unfinished jobs, and the jobs that start once it reaches zero
+struct JobCounter {
+	std::atomic<int32_t> pending{ 0 };
+	std::mutex continuationsMutex;
+	std::vector<Job> continuations;
+};
+
+
+// threadCount includes the calling thread, 0 uses one thread per hardware thread
+void JobSystemInitialize(uint32_t threadCount);
+void JobSystemShutdown();
+uint32_t JobSystemThreadCount();
+
+// Queue a job on the calling thread's deque
+void JobRun(JobCounter& counter, std::function<void()> work);
+
+// Queue a job once dependency has no pending jobs left. It counts as pending on counter right away
+void JobRunAfter(JobCounter& dependency, JobCounter& counter, std::function<void()> work);
+
+// Split [0, count) into ranges of at most grainSize and queue a job for each
+void JobParallelFor(JobCounter& counter, size_t count, size_t grainSize, std::function<void(size_t begin, size_t end)> work);
+
+// Run queued jobs until counter has no pending jobs left
+void JobWait(JobCounter& counter);
@@ -1,33 +1,90 @@
-﻿#pragma comment(lib,"D3D11.lib")
-#pragma comment(lib,"D3dcompiler.lib")
-#pragma comment(lib,"Dxgi.lib")
-
-// Tell OpenXR which platform code we'll be using
-#define XR_USE_PLATFORM_WIN32
-#define XR_USE_GRAPHICS_API_D3D11
-
-#include <d3d11.h>
-#include <directxmath.h>
-#include <d3dcompiler.h>
+﻿#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 #include <openxr/openxr.h>
+
+// Platform time conversion, used to locate hands at the current time on the input thread
+#ifdef _WIN32
+#define XR_USE_PLATFORM_WIN32
+#else
+#define XR_USE_TIMESPEC
+#include <time.h>
+#endif
 #include <openxr/openxr_platform.h>
 
 #include <thread>
+#include <atomic>
 #include <vector>
 #include <algorithm>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include "RenderBackend.h"
+#include "CubeMesh.h"
+#include "SpscRing.h"
+#include "JobSystem.h"
+#include "FrameJobs.h"
+#include "Core/Scene.h"
+#include "Core/Input.h"
+#include "Core/FramePacing.h"
+#include "Telemetry.h"
 
 using namespace std;
-using namespace DirectX;
+
+#ifndef _WIN32
+// MSVC helpers used throughout this file
+#define _countof(array) (sizeof(array) / sizeof(array[0]))
+
+template <size_t size>
+inline void strcpy_s(char (&destination)[size], const char* source)
+{
+	snprintf(destination, size, "%s", source);
+}
+#endif
+
+#ifndef XR_KHR_locate_spaces
+// XR_KHR_locate_spaces is newer than the OpenXR headers of the NuGet package, declare the parts used here
+#define XR_KHR_locate_spaces 1
+#define XR_KHR_LOCATE_SPACES_EXTENSION_NAME "XR_KHR_locate_spaces"
+#define XR_TYPE_SPACES_LOCATE_INFO_KHR ((XrStructureType)1000471000)
+#define XR_TYPE_SPACE_LOCATIONS_KHR ((XrStructureType)1000471001)
+
+typedef struct XrSpacesLocateInfoKHR {
+	XrStructureType type;
+	const void* next;
+	XrSpace baseSpace;
+	XrTime time;
+	uint32_t spaceCount;
+	const XrSpace* spaces;
+} XrSpacesLocateInfoKHR;
+
+typedef struct XrSpaceLocationDataKHR {
+	XrSpaceLocationFlags locationFlags;
+	XrPosef pose;
+} XrSpaceLocationDataKHR;
+
+typedef struct XrSpaceLocationsKHR {
+	XrStructureType type;
+	void* next;
+	uint32_t locationCount;
+	XrSpaceLocationDataKHR* locations;
+} XrSpaceLocationsKHR;
+
+typedef XrResult(XRAPI_PTR* PFN_xrLocateSpacesKHR)(XrSession session, const XrSpacesLocateInfoKHR* locateInfo, XrSpaceLocationsKHR* spaceLocations);
+#endif
 
 
 struct SwapchainInfo {
 	XrSwapchain xrSwapchainHandle;
+	XrSwapchain xrDepthSwapchainHandle; // XR_NULL_HANDLE when depth is not submitted
 	int32_t width;
 	int32_t height;
-	vector<XrSwapchainImageD3D11KHR> xrSwapchainImages;
-	vector<ID3D11DepthStencilView*> depthStencilViews;
-	vector<ID3D11RenderTargetView*> renderTargetViews;
 };
 
 
@@ -40,6 +97,29 @@ inline XrPath StringToPath(XrInstance instance, const char* str) {
 	return path;
 }
 
+// Optional subsystems can be switched with environment variables, so they can be compared without rebuilding. "0" disables
+inline bool OptionEnabled(const char* name, bool defaultValue) {
+#ifdef _WIN32
+	char value[8];
+	const DWORD length = GetEnvironmentVariableA(name, value, (DWORD)sizeof(value));
+	return length == 0 || length >= sizeof(value) ? defaultValue : strcmp(value, "0") != 0;
+#else
+	const char* value = getenv(name);
+	return value == nullptr ? defaultValue : strcmp(value, "0") != 0;
+#endif
+}
+
+inline int OptionInteger(const char* name, int defaultValue) {
+#ifdef _WIN32
+	char value[16];
+	const DWORD length = GetEnvironmentVariableA(name, value, (DWORD)sizeof(value));
+	return length == 0 || length >= sizeof(value) ? defaultValue : atoi(value);
+#else
+	const char* value = getenv(name);
+	return value == nullptr ? defaultValue : atoi(value);
+#endif
+}
+
 // OpenXR
 XrInstance xrInstance = {};
 XrSession xrSession = {};
@@ -47,6 +127,13 @@ XrSessionState xrSessionState = XR_SESSION_STATE_UNKNOWN;
 XrSystemId xrSystemId = XR_NULL_SYSTEM_ID;
 XrEnvironmentBlendMode xrEnvironmentBlendMode = {};
 const char* renderingExtension;
+bool depthLayerExtensionEnabled = false;
+PFN_xrLocateSpacesKHR ext_xrLocateSpacesKHR = nullptr;
+#ifdef _WIN32
+PFN_xrConvertWin32PerformanceCounterToTimeKHR ext_xrConvertWin32PerformanceCounterToTimeKHR = nullptr;
+#else
+PFN_xrConvertTimespecTimeToTimeKHR ext_xrConvertTimespecTimeToTimeKHR = nullptr;
+#endif
 
 XrSpace xrSpace = {};
 XrActionSet xrActionSet;
@@ -61,253 +148,310 @@ uint32_t viewCount = 0;
 vector<XrView> xrViews;
 vector<XrViewConfigurationView> xrViewConfigurationViews;
 vector<SwapchainInfo> SwapchainsInfo;
-
-PFN_xrGetD3D11GraphicsRequirementsKHR ext_xrGetD3D11GraphicsRequirementsKHR = nullptr;
-XrGraphicsRequirementsD3D11KHR xrGraphicsRequirements = { XR_TYPE_GRAPHICS_REQUIREMENTS_D3D11_KHR };
+int64_t swapchainColorFormat = 0;         // in the render backend's graphics API enumeration
+int64_t swapchainDepthFormat = 0;
+bool depthSwapchainFormatSupported = false; // the runtime can create depth swapchains of swapchainDepthFormat
 
 bool IsXrSessionRunning = false;
 
-// Scene and Rendering
-
-// CPU data
-struct ModelConstantBuffer {
-	XMFLOAT4X4 Model;
-};
-
-struct ViewProjectionConstantBuffer {
-	XMFLOAT4X4 ViewProjection;
+// Session recovery, a lost session is recreated on the same instance and device once the system is available again
+const bool sessionRecoveryEnabled = OptionEnabled("OPENXR_EXAMPLE_SESSION_RECOVERY", true);
+const int sessionLossInjectionFrames = OptionInteger("OPENXR_EXAMPLE_INJECT_SESSION_LOSS", 0); // test hook, lose the session every N frames
+const chrono::milliseconds sessionRecoveryRetryInterval(1000);
+bool sessionLost = false;       // the session is destroyed and waits to be recreated
+bool sessionRecovering = false; // lost since the last frame with content
+uint32_t sessionFrameCount = 0; // frames since the session was created
+chrono::steady_clock::time_point sessionLossTime;
+chrono::steady_clock::time_point sessionRecoveryNextAttempt;
+
+// Space location, every space that needs a pose at the predicted display time is located in one batch per frame
+vector<XrSpace> locatedSpaces;
+vector<XrSpaceLocationDataKHR> spaceLocations; // same order as locatedSpaces, read by everything that needs a pose
+uint32_t locatedSpaceIndex_Hands[2];
+
+// Input thread, samples action state and hand poses faster than the frame rate and publishes them to the main thread
+struct InputSample {
+	XrTime time;
+	XrPosef handPoses[2];
+	XrBool32 isHandPoseActive[2];
+	XrBool32 isHandPoseValid[2];
+	XrBool32 isSelectPressed[2]; // select went down since the previous published sample
+	XrTime selectPressTimes[2];  // when it went down, the lastChangeTime of the select action
 };
 
-// GPU settings and resources
-IDXGIAdapter1* graphicsAdapter = nullptr;
-IDXGIFactory1* dxgiFactory;
-DXGI_ADAPTER_DESC1 adapterDesc;
-
-D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0 };
+const bool inputThreadEnabled = OptionEnabled("OPENXR_EXAMPLE_INPUT_THREAD", true);
+const chrono::microseconds inputSamplePeriod(2000); // 500 Hz
+const size_t inputHistoryLength = 64;               // ~128 ms of samples to interpolate from
+
+thread inputThread;
+atomic<bool> inputThreadRunning(false);
+SpscRing<InputSample, 256> inputSamples;
+PoseHistory handPoseHistories[2]; // main thread copy of the most recent valid hand poses
+
+// Rendering
+RenderBackend* renderBackend = nullptr;
+const float clipNear = 0.05f;
+const float clipFar = 100.0f;
+FrameJobs frameJobs;
+const bool occlusionCullingEnabled = OptionEnabled("OPENXR_EXAMPLE_OCCLUSION_CULLING", true);
+
+// Projection layer of the last rendered frame, frames that are not rendered submit it again
+XrCompositionLayerProjection layerProjection = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+vector<XrCompositionLayerProjectionView> layerProjectionViews;
+vector<XrCompositionLayerDepthInfoKHR> layerDepthInfos;
+bool layerProjectionRendered = false; // the swapchain images of layerProjection hold a frame that can be shown again
+
+// Reduced rate rendering while nothing moves, see FramePacing
+const bool framePacingEnabled = OptionEnabled("OPENXR_EXAMPLE_HALF_RATE", true);
+const float framePacingMaxSpeed = 0.02f;       // m/s of the head and the hands that still counts as not moving
+const float framePacingMaxAngularSpeed = 0.1f; // rad/s
+FramePacing framePacing;
+vector<Pose> framePacingViewPoses;             // of the previous frame
+Pose framePacingHandPoses[2];
+XrBool32 framePacingHandActive[2];
+size_t framePacingCubeCount = 0;
 
-ID3D11Device* d3dDevice = nullptr;
-ID3D11DeviceContext* d3dContext = nullptr;
-
-ID3D11VertexShader* vertexShader;
-ID3D11PixelShader* pixelShader;
-ID3D11InputLayout* inputLayout;
-ID3D11Buffer* modelConstantBuffer;
-ID3D11Buffer* viewProjectionConstantBuffer;
-ID3D11Buffer* vertexBuffer;
-ID3D11Buffer* indexBuffer;
+// Scene
+Scene scene;
+static_assert(sizeof(Pose) == sizeof(XrPosef), "OpenXR poses are handed to the scene and the frame jobs as Pose");
+
+
+// Startup
+struct StartupTask {
+	const char* name;
+	vector<size_t> dependencies; // indices of tasks that must finish first, always listed before this task
+	function<bool()> work;
+	chrono::steady_clock::time_point start;
+	chrono::steady_clock::time_point end;
+	bool succeeded;
+};
 
+vector<StartupTask> startupTasks;
+chrono::steady_clock::time_point startupTime = chrono::steady_clock::now();
+chrono::steady_clock::time_point startupFirstFrameTime;
 
-constexpr char shader[] = R"_(
+// Telemetry
+XrTime telemetryLastDisplayTime = 0; // predicted display time of the previous frame, to count missed display periods
+vector<XrTime> telemetryPendingPlacements; // select press times of placed cubes that no submitted frame showed yet
+XrTime telemetryLayerHandLocateTime = 0;   // when the hand poses in layerProjection were located, 0 without hand cubes in it
+uint32_t telemetryLatencyModes = 0;        // telemetryMode* flags the latency histograms were collected with
 
-cbuffer ModelConstantBuffer : register(b0) 
-{
-	float4x4 Model;
-};
+////////////////////////////////////////////////
+// Startup timeline
+////////////////////////////////////////////////
 
-cbuffer ViewProjectionConstantBuffer : register(b1) 
+bool StartupRunTasks(vector<StartupTask>& tasks)
 {
-	float4x4 ViewProjection;
-};
+	vector<shared_future<bool>> completions(tasks.size());
 
-struct VertexShaderInput 
-{
-	float4 pos   : SV_POSITION;
-	float3 color : COLOR0;
-};
+	// Launch every task on its own thread, each one first waits for the completion of its dependencies
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		StartupTask* task = &tasks[i];
+		vector<shared_future<bool>> dependencies;
+		for (size_t dependency : task->dependencies)
+		{
+			dependencies.push_back(completions[dependency]);
+		}
 
-struct VertexShaderOutput 
-{
-	float4 pos   : SV_POSITION;
-	float3 color : COLOR0;
-};
+		completions[i] = async(launch::async, [task, dependencies]()
+		{
+			task->succeeded = false;
+			for (const shared_future<bool>& dependency : dependencies)
+			{
+				if (!dependency.get())
+				{
+					return false;
+				}
+			}
 
-VertexShaderOutput vs(VertexShaderInput input) 
-{
-	VertexShaderOutput output;
+			task->start = chrono::steady_clock::now();
+			task->succeeded = task->work();
+			task->end = chrono::steady_clock::now();
+			return task->succeeded;
+		}).share();
+	}
 
-	output.pos = mul(float4(input.pos.xyz, 1), Model);
-	output.pos = mul(output.pos, ViewProjection);
+	bool succeeded = true;
+	for (const shared_future<bool>& completion : completions)
+	{
+		succeeded = completion.get() && succeeded;
+	}
 
-	output.color = input.color;
-	return output;
+	return succeeded;
 }
 
-float4 ps(VertexShaderOutput input) : SV_TARGET 
-{
-	return float4(input.color, 1);
-})_";
-
-float cubeVertices[] =
-{
-	-1.0f, -1.0f, -1.0f,     0.0f, 0.0f, 0.0f,
-	-1.0f, -1.0f,  1.0f,     0.0f, 0.0f, 1.0f,
-	-1.0f,  1.0f, -1.0f,     0.0f, 1.0f, 0.0f,
-	-1.0f,  1.0f,  1.0f,     0.0f, 1.0f, 1.0f,
-	 1.0f, -1.0f, -1.0f,     1.0f, 0.0f, 0.0f,
-	 1.0f, -1.0f,  1.0f,     1.0f, 0.0f, 1.0f,
-	 1.0f,  1.0f, -1.0f,     1.0f, 1.0f, 0.0f,
-	 1.0f,  1.0f,  1.0f,     1.0f, 1.0f, 1.0f,
-};
 
-uint16_t cubeIndices[] =
+void StartupReportTimeline()
 {
-	2,1,0, // -x
-	2,3,1,
+	auto milliseconds = [](chrono::steady_clock::duration duration) { return chrono::duration<double, milli>(duration).count(); };
 
-	6,4,5, // +x
-	6,5,7,
+	// Walk back from the task that finished last through the dependency that finished last, this is the critical path.
+	// A task's contribution is the time between its critical dependency (or process start) finishing and itself finishing
+	vector<double> criticalContribution(startupTasks.size(), 0.0);
+	{
+		size_t last = 0;
+		for (size_t i = 1; i < startupTasks.size(); i++)
+		{
+			if (startupTasks[i].end > startupTasks[last].end) last = i;
+		}
 
-	0,1,5, // -y
-	0,5,4,
+		for (size_t current = last; ; )
+		{
+			const StartupTask& task = startupTasks[current];
+			size_t critical = SIZE_MAX;
+			for (size_t dependency : task.dependencies)
+			{
+				if (critical == SIZE_MAX || startupTasks[dependency].end > startupTasks[critical].end) critical = dependency;
+			}
 
-	2,6,7, // +y
-	2,7,3,
+			chrono::steady_clock::time_point ready = critical == SIZE_MAX ? startupTime : startupTasks[critical].end;
+			criticalContribution[current] = milliseconds(task.end - ready);
 
-	0,4,6, // -z
-	0,6,2,
+			if (critical == SIZE_MAX) break;
+			current = critical;
+		}
+	}
 
-	1,3,7, // +z
-	1,7,5,
-};
+	printf("Startup timeline (ms)\n");
+	printf("  %-20s %10s %10s %10s\n", "task", "start", "duration", "critical");
+	chrono::steady_clock::time_point initializedTime = startupTime;
+	for (size_t i = 0; i < startupTasks.size(); i++)
+	{
+		const StartupTask& task = startupTasks[i];
+		printf("  %-20s %10.2f %10.2f %10.2f\n", task.name, milliseconds(task.start - startupTime), milliseconds(task.end - task.start), criticalContribution[i]);
+		initializedTime = max(initializedTime, task.end);
+	}
 
+	// Everything after initialization until the first submitted layer (session readiness, first frame wait and render) is critical too
+	printf("  %-20s %10.2f %10.2f %10.2f\n", "FirstFrame", milliseconds(initializedTime - startupTime), milliseconds(startupFirstFrameTime - initializedTime), milliseconds(startupFirstFrameTime - initializedTime));
+	printf("Time to first frame: %.2f ms\n", milliseconds(startupFirstFrameTime - startupTime));
+}
 
-// Scene
-vector<XrPosef> cubes(2, POSE_IDENTITY);
 
 ////////////////////////////////////////////////
-// Graphics - Direct3D                             
+// OpenXR                             
 ////////////////////////////////////////////////
 
-void D3DShutdown() 
+uint32_t OpenXRAddLocatedSpace(XrSpace space)
 {
-	if (d3dContext) 
-	{ 
-		d3dContext->Release(); 
-		d3dContext = nullptr; 
-	}
-	if (d3dDevice) 
-	{ 
-		d3dDevice->Release();  
-		d3dDevice = nullptr; 
-	}
+	// Returns the index of the space's location in spaceLocations
+	locatedSpaces.push_back(space);
+	spaceLocations.push_back({});
+	return (uint32_t)(locatedSpaces.size() - 1);
 }
 
 
-void D3DDestroySwapchain(SwapchainInfo& swapchain) 
+void OpenXRLocateSpaces(XrTime time)
 {
-	for (uint32_t i = 0; i < swapchain.xrSwapchainImages.size(); i++) 
+	if (locatedSpaces.empty())
 	{
-		swapchain.depthStencilViews[i]->Release();
-		swapchain.renderTargetViews[i]->Release();
+		return;
 	}
-}
-
 
-XMMATRIX D3DGetProjectionMatrix(XrFovf fov, float clip_near, float clip_far) 
-{
-	const float left = clip_near * tanf(fov.angleLeft);
-	const float right = clip_near * tanf(fov.angleRight);
-	const float down = clip_near * tanf(fov.angleDown);
-	const float up = clip_near * tanf(fov.angleUp);
 
-	return XMMatrixPerspectiveOffCenterRH(left, right, down, up, clip_near, clip_far);
-}
+	// Locate every registered space relative to the scene's reference space in a single runtime call
+	{
+		if (ext_xrLocateSpacesKHR != nullptr)
+		{
+			XrSpacesLocateInfoKHR spacesLocateInfo = { XR_TYPE_SPACES_LOCATE_INFO_KHR };
+			spacesLocateInfo.baseSpace = xrSpace;
+			spacesLocateInfo.time = time;
+			spacesLocateInfo.spaceCount = (uint32_t)locatedSpaces.size();
+			spacesLocateInfo.spaces = locatedSpaces.data();
 
+			XrSpaceLocationsKHR xrSpaceLocations = { XR_TYPE_SPACE_LOCATIONS_KHR };
+			xrSpaceLocations.locationCount = (uint32_t)spaceLocations.size();
+			xrSpaceLocations.locations = spaceLocations.data();
 
-ID3DBlob* D3DCompileShader(const char* hlsl, const char* entrypoint, const char* target) {
-	DWORD flags = D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
-#ifdef _DEBUG
-	flags |= D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_DEBUG;
-#else
-	flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-#endif
+			if (XR_SUCCEEDED(ext_xrLocateSpacesKHR(xrSession, &spacesLocateInfo, &xrSpaceLocations)))
+			{
+				return;
+			}
+		}
+	}
 
-	ID3DBlob* compiled, * errors;
-	if (FAILED(D3DCompile(hlsl, strlen(hlsl), nullptr, nullptr, nullptr, entrypoint, target, flags, 0, &compiled, &errors)))
-		printf("Error: D3DCompile failed %s", (char*)errors->GetBufferPointer());
-	if (errors) errors->Release();
 
-	return compiled;
+	// Without the extension, locate them back to back here so the results look the same to the rest of the frame
+	for (size_t i = 0; i < locatedSpaces.size(); i++)
+	{
+		XrSpaceLocation spaceLocation = { XR_TYPE_SPACE_LOCATION };
+		if (XR_UNQUALIFIED_SUCCESS(xrLocateSpace(locatedSpaces[i], xrSpace, time, &spaceLocation)))
+		{
+			spaceLocations[i] = { spaceLocation.locationFlags, spaceLocation.pose };
+		}
+		else
+		{
+			spaceLocations[i] = { 0, POSE_IDENTITY };
+		}
+	}
 }
 
 
-void D3DInitializeResources()
+bool OpenXRCreateInstance()
 {
-	// Compile our shader code, and turn it into a shader resource!
-	ID3DBlob* vertexShaderBytes = D3DCompileShader(shader, "vs", "vs_5_0");
-	ID3DBlob* pixelShaderBytes = D3DCompileShader(shader, "ps", "ps_5_0");
-	d3dDevice->CreateVertexShader(vertexShaderBytes->GetBufferPointer(), vertexShaderBytes->GetBufferSize(), nullptr, &vertexShader);
-	d3dDevice->CreatePixelShader(pixelShaderBytes->GetBufferPointer(), pixelShaderBytes->GetBufferSize(), nullptr, &pixelShader);
-
-
-	// CREATE INPUT LAYOUT                               
-	// Describe how our mesh is laid out in memory
-	D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
-	{
-		{"SV_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-	};
-
-	d3dDevice->CreateInputLayout(vertexDesc, (UINT)_countof(vertexDesc), vertexShaderBytes->GetBufferPointer(), vertexShaderBytes->GetBufferSize(), &inputLayout);
-
-
-	// CREATE GPU RESOURCES FROM VERTEX BUFFER, INDICES BUFFER, CONSTANT BUFFERS (NO DATA YET) // declared buffers on GPU, create by GPU and pass reference back  
-	// its same as buffer b = new buffer, but gpu does creation and memory management?                           
-	// Create GPU resources for our mesh's vertices and indices! Constant buffers are for passing transform
-	// matrices into the shaders, so make a buffer for them too!
-	D3D11_SUBRESOURCE_DATA vertexBufferData = { cubeVertices };
-	D3D11_SUBRESOURCE_DATA indexBufferData = { cubeIndices };
-
-	CD3D11_BUFFER_DESC vertexBufferDesc(sizeof(cubeVertices), D3D11_BIND_VERTEX_BUFFER);
-	CD3D11_BUFFER_DESC indexBufferDesc(sizeof(cubeIndices), D3D11_BIND_INDEX_BUFFER);
-
-	CD3D11_BUFFER_DESC modelConstantBufferDesc(sizeof(ModelConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
-	CD3D11_BUFFER_DESC viewProjectionConstantBufferDesc(sizeof(ViewProjectionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
-
-	d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &vertexBuffer);
-	d3dDevice->CreateBuffer(&indexBufferDesc, &indexBufferData, &indexBuffer);
-	d3dDevice->CreateBuffer(&modelConstantBufferDesc, nullptr, &modelConstantBuffer); // no data yet, constant buffer will  be updated every frame
-	d3dDevice->CreateBuffer(&viewProjectionConstantBufferDesc, nullptr, &viewProjectionConstantBuffer);
-}
-
+	vector<const char*> enabledExtensions;
+	bool locateSpacesExtensionEnabled = false;
+	bool convertTimeExtensionEnabled = false;
 
-////////////////////////////////////////////////
-// OpenXR                             
-////////////////////////////////////////////////
 
-bool OpenXRInitialize()
-{
-	// Check if Direct3D 11 extension is available
+	// Check if the render backend's graphics API extension is available, and enable the optional extensions the runtime has
 	{
-		renderingExtension = XR_KHR_D3D11_ENABLE_EXTENSION_NAME;
-		bool renderingExtensionFound = false;
+		renderingExtension = renderBackend->GetRenderingExtension();
 
 		uint32_t availableExtensionsCount = 0;
 		xrEnumerateInstanceExtensionProperties(nullptr, 0, &availableExtensionsCount, nullptr);
 		vector<XrExtensionProperties> xrAvailableExtensions(availableExtensionsCount, { XR_TYPE_EXTENSION_PROPERTIES });
 		xrEnumerateInstanceExtensionProperties(nullptr, availableExtensionsCount, &availableExtensionsCount, xrAvailableExtensions.data());
 
-		for (size_t i = 0; i < availableExtensionsCount; i++)
+		auto isExtensionAvailable = [&](const char* extension)
 		{
-			if (strcmp(renderingExtension, xrAvailableExtensions[i].extensionName) == 0)
+			for (size_t i = 0; i < availableExtensionsCount; i++)
 			{
-				renderingExtensionFound = true;
-				break;
+				if (strcmp(extension, xrAvailableExtensions[i].extensionName) == 0)
+				{
+					return true;
+				}
 			}
-		}
+			return false;
+		};
 
-		if (!renderingExtensionFound)
+		if (!isExtensionAvailable(renderingExtension))
 		{
 			return false;
 		}
+		enabledExtensions.push_back(renderingExtension);
+
+		if (isExtensionAvailable(XR_KHR_LOCATE_SPACES_EXTENSION_NAME))
+		{
+			enabledExtensions.push_back(XR_KHR_LOCATE_SPACES_EXTENSION_NAME);
+			locateSpacesExtensionEnabled = true;
+		}
+
+#ifdef _WIN32
+		const char* convertTimeExtension = XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME;
+#else
+		const char* convertTimeExtension = XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME;
+#endif
+		if (isExtensionAvailable(convertTimeExtension))
+		{
+			enabledExtensions.push_back(convertTimeExtension);
+			convertTimeExtensionEnabled = true;
+		}
+
+		if (isExtensionAvailable(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME) && OptionEnabled("OPENXR_EXAMPLE_DEPTH_LAYER", true))
+		{
+			enabledExtensions.push_back(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
+			depthLayerExtensionEnabled = true;
+		}
 	}
 
 
 	// Create XRInstance
 	{
 		XrInstanceCreateInfo xrInstanceCreateInfo = { XR_TYPE_INSTANCE_CREATE_INFO };
-		xrInstanceCreateInfo.enabledExtensionCount = 1;
-		xrInstanceCreateInfo.enabledExtensionNames = &renderingExtension;
+		xrInstanceCreateInfo.enabledExtensionCount = (uint32_t)enabledExtensions.size();
+		xrInstanceCreateInfo.enabledExtensionNames = enabledExtensions.data();
 		xrInstanceCreateInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
 		strcpy_s(xrInstanceCreateInfo.applicationInfo.applicationName, "OpenXR Example");
 
@@ -320,9 +464,25 @@ bool OpenXRInitialize()
 	}
 
 
-	// Get pointer to GetGraphicsRequirements function from extension
+	// Get the batched space location function, without it spaces are located one call at a time
 	{
-		xrGetInstanceProcAddr(xrInstance, "xrGetD3D11GraphicsRequirementsKHR", (PFN_xrVoidFunction*)(&ext_xrGetD3D11GraphicsRequirementsKHR));
+		if (locateSpacesExtensionEnabled)
+		{
+			xrGetInstanceProcAddr(xrInstance, "xrLocateSpacesKHR", (PFN_xrVoidFunction*)&ext_xrLocateSpacesKHR);
+		}
+	}
+
+
+	// Get the function converting the platform clock to XrTime, the input thread needs it to know what time it is
+	{
+		if (convertTimeExtensionEnabled)
+		{
+#ifdef _WIN32
+			xrGetInstanceProcAddr(xrInstance, "xrConvertWin32PerformanceCounterToTimeKHR", (PFN_xrVoidFunction*)&ext_xrConvertWin32PerformanceCounterToTimeKHR);
+#else
+			xrGetInstanceProcAddr(xrInstance, "xrConvertTimespecTimeToTimeKHR", (PFN_xrVoidFunction*)&ext_xrConvertTimespecTimeToTimeKHR);
+#endif
+		}
 	}
 
 
@@ -385,7 +545,12 @@ bool OpenXRInitialize()
 		xrSuggestInteractionProfileBindings(xrInstance, &interactionProfileSuggestedBindings);
 	}
 
+	return true;
+}
+
 
+bool OpenXRGetSystem()
+{
 	// Get System ID for head mounted display form factor
 	{
 		XrSystemGetInfo systemInfo = { XR_TYPE_SYSTEM_GET_INFO };
@@ -404,60 +569,16 @@ bool OpenXRInitialize()
 		xrEnvironmentBlendMode = xrEnvironmentBlendModes[0];
 	}
 
-
-	// Get D3D11 Graphics requirements for the app
-	{
-		ext_xrGetD3D11GraphicsRequirementsKHR(xrInstance, xrSystemId, &xrGraphicsRequirements);
-	}
-
-
-	// Create DXGI Factory
-	{
-		CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)(&dxgiFactory));
-	}
-
-
-	// Use DXGI Factory to try finding graphics card with matching luid from graphics requirements
-	{
-		int adapterIndex = 0;
-		bool foundAdapter = false;
-		while (dxgiFactory->EnumAdapters1(adapterIndex++, &graphicsAdapter) == S_OK) 
-		{
-			graphicsAdapter->GetDesc1(&adapterDesc);
-
-			if (memcmp(&adapterDesc.AdapterLuid, &xrGraphicsRequirements.adapterLuid, sizeof(&xrGraphicsRequirements.adapterLuid)) == 0) {
-				foundAdapter = true;
-				break;
-			}
-
-		}
-		dxgiFactory->Release();
-
-		if (!foundAdapter)
-		{
-			return false;
-		}
-	}
-
-
-	// Create D3D11 device for required feature levels
-	{
-		if (FAILED(D3D11CreateDevice(graphicsAdapter, D3D_DRIVER_TYPE_UNKNOWN, 0, 0, featureLevels, _countof(featureLevels), D3D11_SDK_VERSION, &d3dDevice, nullptr, &d3dContext)))
-		{
-			return false;
-		}
-
-		graphicsAdapter->Release();
-	}
+	return true;
+}
 
 
-	// Create XRSession with graphics device and system ID
+bool OpenXRCreateSession()
+{
+	// Create XRSession with render backend graphics device and system ID
 	{
-		XrGraphicsBindingD3D11KHR xrGraphicsBinding = { XR_TYPE_GRAPHICS_BINDING_D3D11_KHR };
-		xrGraphicsBinding.device = d3dDevice;
-
 		XrSessionCreateInfo xrCreateSessionInfo = { XR_TYPE_SESSION_CREATE_INFO };
-		xrCreateSessionInfo.next = &xrGraphicsBinding;
+		xrCreateSessionInfo.next = renderBackend->GetGraphicsBinding();
 		xrCreateSessionInfo.systemId = xrSystemId;
 		xrCreateSession(xrInstance, &xrCreateSessionInfo, &xrSession);
 
@@ -494,6 +615,100 @@ bool OpenXRInitialize()
 		xrActionSpaceCreateInfo.poseInActionSpace = POSE_IDENTITY;
 		xrActionSpaceCreateInfo.subactionPath = xrPath_HandSubactions[i];
 		xrCreateActionSpace(xrSession, &xrActionSpaceCreateInfo, &xrSpace_Hands[i]);
+		locatedSpaceIndex_Hands[i] = OpenXRAddLocatedSpace(xrSpace_Hands[i]);
+	}
+
+	return true;
+}
+
+
+// Index of the first format in the runtime's list, which is ordered by its preference, that is also in the backend's
+// list. Formats the runtime prefers most need no conversion in the compositor
+int32_t OpenXRSelectSwapchainFormat(const vector<int64_t>& runtimeFormats, const vector<int64_t>& backendFormats)
+{
+	for (int32_t i = 0; i < (int32_t)runtimeFormats.size(); i++)
+	{
+		if (find(backendFormats.begin(), backendFormats.end(), runtimeFormats[i]) != backendFormats.end())
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+bool OpenXRSelectSwapchainFormats()
+{
+	vector<int64_t> runtimeFormats;
+
+
+	// Formats the runtime can create swapchains with for this session
+	{
+		uint32_t formatCount = 0;
+		if (XR_SUCCEEDED(xrEnumerateSwapchainFormats(xrSession, 0, &formatCount, nullptr)))
+		{
+			runtimeFormats.resize(formatCount);
+			if (XR_FAILED(xrEnumerateSwapchainFormats(xrSession, formatCount, &formatCount, runtimeFormats.data())))
+			{
+				formatCount = 0;
+			}
+		}
+		runtimeFormats.resize(formatCount);
+	}
+
+
+	// Pick color and depth format, without a depth format the runtime supports depth stays in the backend's own buffers
+	{
+		const vector<int64_t>& colorFormats = renderBackend->GetSwapchainFormats();
+		const vector<int64_t>& depthFormats = renderBackend->GetDepthSwapchainFormats();
+
+		// Without the runtime's list take the backend's first formats and let swapchain creation tell whether they work,
+		// depth is not submitted as it may not be supported
+		if (runtimeFormats.empty())
+		{
+			swapchainColorFormat = colorFormats[0];
+			swapchainDepthFormat = depthFormats[0];
+			depthSwapchainFormatSupported = false;
+
+			printf("Runtime lists no swapchain formats, using the backend's first color format %s and depth buffers of our own\n", renderBackend->GetFormatName(swapchainColorFormat));
+			return renderBackend->SetSwapchainFormats(swapchainColorFormat, swapchainDepthFormat);
+		}
+
+		const int32_t colorIndex = OpenXRSelectSwapchainFormat(runtimeFormats, colorFormats);
+		const int32_t depthIndex = OpenXRSelectSwapchainFormat(runtimeFormats, depthFormats);
+		if (colorIndex < 0)
+		{
+			printf("None of the %u swapchain formats of the runtime can be rendered to\n", (uint32_t)runtimeFormats.size());
+			return false;
+		}
+
+		swapchainColorFormat = runtimeFormats[colorIndex];
+		swapchainDepthFormat = depthIndex >= 0 ? runtimeFormats[depthIndex] : depthFormats[0];
+		depthSwapchainFormatSupported = depthIndex >= 0;
+
+		printf("Swapchain color format %s, runtime preference %d of %u\n", renderBackend->GetFormatName(swapchainColorFormat), colorIndex + 1, (uint32_t)runtimeFormats.size());
+		if (depthIndex >= 0)
+		{
+			printf("Swapchain depth format %s, runtime preference %d of %u\n", renderBackend->GetFormatName(swapchainDepthFormat), depthIndex + 1, (uint32_t)runtimeFormats.size());
+		}
+		else
+		{
+			printf("No depth swapchain format in common with the runtime, rendering depth into %s buffers of our own\n", renderBackend->GetFormatName(swapchainDepthFormat));
+		}
+	}
+
+	return renderBackend->SetSwapchainFormats(swapchainColorFormat, swapchainDepthFormat);
+}
+
+
+bool OpenXRCreateSwapchains()
+{
+	// Agree on the formats with the runtime first, render targets are created for them
+	{
+		if (!OpenXRSelectSwapchainFormats())
+		{
+			return false;
+		}
 	}
 
 
@@ -513,7 +728,6 @@ bool OpenXRInitialize()
 		XrSwapchain xrSwapChain;
 		XrSwapchainCreateInfo xrSwapchainCreateInfo = { XR_TYPE_SWAPCHAIN_CREATE_INFO };
 		SwapchainInfo swapchainInfo = {};
-		uint32_t swapchainLength = 0;
 
 
 		// Use info from viewpoint view configuration view to create swapchain
@@ -522,7 +736,7 @@ bool OpenXRInitialize()
 			xrSwapchainCreateInfo.arraySize = 1;
 			xrSwapchainCreateInfo.mipCount = 1;
 			xrSwapchainCreateInfo.faceCount = 1;
-			xrSwapchainCreateInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			xrSwapchainCreateInfo.format = swapchainColorFormat;
 			xrSwapchainCreateInfo.width = xrViewConfigurationView.recommendedImageRectWidth;
 			xrSwapchainCreateInfo.height = xrViewConfigurationView.recommendedImageRectHeight;
 			xrSwapchainCreateInfo.sampleCount = xrViewConfigurationView.recommendedSwapchainSampleCount;
@@ -532,73 +746,37 @@ bool OpenXRInitialize()
 		}
 
 
-		// Find out how many textures were generated for the swapchain by device runtime
-		{
-			xrEnumerateSwapchainImages(xrSwapChain, 0, &swapchainLength, nullptr);
-		}
-
-
-		// Cache created swapchain handle, dimension, images and views, so we can draw onto it later
+		// Cache created swapchain handle and dimension
 		{
 			swapchainInfo.width = xrSwapchainCreateInfo.width;
 			swapchainInfo.height = xrSwapchainCreateInfo.height;
 			swapchainInfo.xrSwapchainHandle = xrSwapChain;
-			swapchainInfo.xrSwapchainImages.resize(swapchainLength, { XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR });
-			swapchainInfo.depthStencilViews.resize(swapchainLength);
-			swapchainInfo.renderTargetViews.resize(swapchainLength);
-		}
-
-
-		// Cache swapchain images created by runtime device
-		{
-			xrEnumerateSwapchainImages(swapchainInfo.xrSwapchainHandle, swapchainLength, &swapchainLength, (XrSwapchainImageBaseHeader*)swapchainInfo.xrSwapchainImages.data());
+			swapchainInfo.xrDepthSwapchainHandle = XR_NULL_HANDLE;
 		}
 
 
-		// Create render target view and depth stencial view for every swapchain image
-		for (uint32_t i = 0; i < swapchainLength; i++)
+		// Create a depth swapchain of the same size, the runtime uses its depth to reproject the view more accurately
 		{
-			D3D11_TEXTURE2D_DESC colorTextureDesc;
-			ID3D11Texture2D* depthTexture;
-
-
-			// Create render target view resource for swapchain image
-			{			
-				swapchainInfo.xrSwapchainImages[i].texture->GetDesc(&colorTextureDesc);
-
-				D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc = {};
-				renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-				renderTargetViewDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-				d3dDevice->CreateRenderTargetView(swapchainInfo.xrSwapchainImages[i].texture, &renderTargetViewDesc, &swapchainInfo.renderTargetViews[i]);
-			}
-			
-			
-			// Create texture for depth stencil
+			if (depthLayerExtensionEnabled && depthSwapchainFormatSupported)
 			{
-				D3D11_TEXTURE2D_DESC depthTextureDesc = {};
-				depthTextureDesc.SampleDesc.Count = 1;
-				depthTextureDesc.MipLevels = 1;
-				depthTextureDesc.Width = colorTextureDesc.Width;
-				depthTextureDesc.Height = colorTextureDesc.Height;
-				depthTextureDesc.ArraySize = colorTextureDesc.ArraySize;
-				depthTextureDesc.Format = DXGI_FORMAT_R32_TYPELESS;
-				depthTextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_DEPTH_STENCIL;
-				
-				d3dDevice->CreateTexture2D(&depthTextureDesc, nullptr, &depthTexture);
+				xrSwapchainCreateInfo.format = swapchainDepthFormat;
+				xrSwapchainCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+				if (XR_FAILED(xrCreateSwapchain(xrSession, &xrSwapchainCreateInfo, &swapchainInfo.xrDepthSwapchainHandle)))
+				{
+					printf("Depth swapchain could not be created, submitting color only\n");
+					swapchainInfo.xrDepthSwapchainHandle = XR_NULL_HANDLE;
+				}
 			}
+		}
 
 
-			// Create depth stencil view resource for swapchain image
+		// Let the render backend create render targets for the swapchain images created by runtime device, so we can draw onto them later
+		{
+			if (!renderBackend->CreateSwapchainImages(i, xrSwapChain, swapchainInfo.xrDepthSwapchainHandle, swapchainInfo.width, swapchainInfo.height))
 			{
-				D3D11_DEPTH_STENCIL_VIEW_DESC dephViewDesc = {};
-				dephViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-				dephViewDesc.Format = DXGI_FORMAT_D32_FLOAT;
-				d3dDevice->CreateDepthStencilView(depthTexture, &dephViewDesc, &swapchainInfo.depthStencilViews[i]);
+				return false;
 			}
-
-
-			// We don't need direct access to the ID3D11Texture2D object anymore, we only need the view
-			depthTexture->Release();
 		}
 
 		SwapchainsInfo.push_back(swapchainInfo);
@@ -608,20 +786,349 @@ bool OpenXRInitialize()
 }
 
 
-
-void OpenXRProcessEvents(bool& exit) 
+bool OpenXRInitialize()
 {
-	XrEventDataBuffer eventData = { XR_TYPE_EVENT_DATA_BUFFER };
+	// Startup work runs as a small task graph: every task starts as soon as the tasks it depends on have finished.
+	// Shader compilation only needs the compiler, so it overlaps with instance, system, device and session creation,
+	// and GPU resources are created on the device while the session is still being created. Swapchains wait for both,
+	// the render state for the swapchain formats the runtime prefers is created with them
+	enum { CreateInstance, GetSystem, CreateDevice, CompileShaders, InitializeResources, CreateSession, CreateSwapchains };
 
-	// Process all OpenXR events
-	while (xrPollEvent(xrInstance, &eventData) == XR_SUCCESS) 
+	startupTasks =
 	{
-		// We are mainly interested in Session state changes
-		switch (eventData.type) 
-		{
+		{ "CreateInstance", {}, OpenXRCreateInstance },
+		{ "GetSystem", { CreateInstance }, OpenXRGetSystem },
+		{ "CreateDevice", { GetSystem }, []() { return renderBackend->CreateDevice(xrInstance, xrSystemId); } },
+		{ "CompileShaders", {}, []() { return renderBackend->CompileShaders(); } },
+		{ "InitializeResources", { CreateDevice, CompileShaders }, []() { return renderBackend->InitializeResources(); } },
+		{ "CreateSession", { CreateDevice }, OpenXRCreateSession },
+		{ "CreateSwapchains", { CreateSession, InitializeResources }, OpenXRCreateSwapchains },
+	};
+
+	if (!StartupRunTasks(startupTasks))
+	{
+		return false;
+	}
+
+
+	// Publish how long startup took
+	{
+		const double startupMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - startupTime).count();
+		TelemetryWriteCounters([startupMilliseconds](TelemetryCounters& counters)
+		{
+			counters.startupMilliseconds = startupMilliseconds;
+			counters.viewCount = viewCount;
+		});
+	}
+
+	return true;
+}
+
+
+
+bool OpenXRGetCurrentTime(XrTime& time)
+{
+#ifdef _WIN32
+	if (ext_xrConvertWin32PerformanceCounterToTimeKHR == nullptr)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER performanceCounter;
+	QueryPerformanceCounter(&performanceCounter);
+	return XR_SUCCEEDED(ext_xrConvertWin32PerformanceCounterToTimeKHR(xrInstance, &performanceCounter, &time));
+#else
+	if (ext_xrConvertTimespecTimeToTimeKHR == nullptr)
+	{
+		return false;
+	}
+
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return XR_SUCCEEDED(ext_xrConvertTimespecTimeToTimeKHR(xrInstance, &now, &time));
+#endif
+}
+
+
+void InputThreadRun()
+{
+	// Select presses that could not be published because the ring was full, carried over to the next sample
+	PressLatch selectPresses[2];
+
+	chrono::steady_clock::time_point nextSampleTime = chrono::steady_clock::now();
+	while (inputThreadRunning.load(memory_order_acquire))
+	{
+		InputSample sample = {};
+
+
+		// Sync actions with up-to-date input data, the input thread owns action syncing while it runs
+		{
+			XrActiveActionSet xrActiveActionSet = { };
+			xrActiveActionSet.actionSet = xrActionSet;
+			xrActiveActionSet.subactionPath = XR_NULL_PATH;
+
+			XrActionsSyncInfo xrActionsSyncInfo = { XR_TYPE_ACTIONS_SYNC_INFO };
+			xrActionsSyncInfo.countActiveActionSets = 1;
+			xrActionsSyncInfo.activeActionSets = &xrActiveActionSet;
+
+			xrSyncActions(xrSession, &xrActionsSyncInfo);
+		}
+
+
+		// Sample action state and locate the hands now, not at a frame's predicted display time
+		if (OpenXRGetCurrentTime(sample.time))
+		{
+			for (uint32_t handIndex = 0; handIndex < 2; handIndex++)
+			{
+				XrActionStateGetInfo actionInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
+				actionInfo.subactionPath = xrPath_HandSubactions[handIndex];
+
+				XrActionStatePose handPoseState = { XR_TYPE_ACTION_STATE_POSE };
+				actionInfo.action = xrAction_HandPose;
+				xrGetActionStatePose(xrSession, &actionInfo, &handPoseState);
+				sample.isHandPoseActive[handIndex] = handPoseState.isActive;
+
+				XrActionStateBoolean handSelectState = { XR_TYPE_ACTION_STATE_BOOLEAN };
+				actionInfo.action = xrAction_Select;
+				xrGetActionStateBoolean(xrSession, &actionInfo, &handSelectState);
+				PressLatchUpdate(selectPresses[handIndex], handSelectState.currentState, handSelectState.changedSinceLastSync, handSelectState.lastChangeTime);
+
+				XrSpaceLocation handSpaceLocation = { XR_TYPE_SPACE_LOCATION };
+				sample.isHandPoseValid[handIndex] =
+					XR_UNQUALIFIED_SUCCESS(xrLocateSpace(xrSpace_Hands[handIndex], xrSpace, sample.time, &handSpaceLocation)) &&
+					(handSpaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
+					(handSpaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
+				sample.handPoses[handIndex] = sample.isHandPoseValid[handIndex] ? handSpaceLocation.pose : POSE_IDENTITY;
+
+				sample.isSelectPressed[handIndex] = selectPresses[handIndex].pressed;
+				sample.selectPressTimes[handIndex] = selectPresses[handIndex].time;
+			}
+
+			if (inputSamples.Push(sample))
+			{
+				selectPresses[0] = selectPresses[1] = {};
+			}
+		}
+
+
+		// Fixed rate, independent of the frame loop
+		{
+			nextSampleTime += inputSamplePeriod;
+			this_thread::sleep_until(nextSampleTime);
+		}
+	}
+}
+
+
+void InputThreadStart()
+{
+	// Only with a way to get the current XrTime, otherwise input stays sampled once per frame in OpenXRPollActions
+	XrTime time;
+	if (!inputThreadEnabled || inputThreadRunning || !OpenXRGetCurrentTime(time))
+	{
+		return;
+	}
+
+	inputSamples.Clear();
+	PoseHistoryInitialize(handPoseHistories[0], inputHistoryLength);
+	PoseHistoryInitialize(handPoseHistories[1], inputHistoryLength);
+	inputThreadRunning = true;
+	inputThread = thread(InputThreadRun);
+}
+
+
+void InputThreadStop()
+{
+	if (inputThreadRunning)
+	{
+		inputThreadRunning = false;
+		inputThread.join();
+	}
+}
+
+
+// Count a placed cube and how long ago its select press happened, when there is a way to know what time it is now. The
+// press to display latency is recorded once a frame shows the cube
+void InputReportPlacement(XrTime selectPressTime)
+{
+	telemetryPendingPlacements.push_back(selectPressTime);
+
+	XrTime now;
+	const double latencyMilliseconds = OpenXRGetCurrentTime(now) ? (double)(now - selectPressTime) / 1e6 : 0.0;
+
+	TelemetryWriteCounters([latencyMilliseconds](TelemetryCounters& counters)
+	{
+		counters.placedCubeCount++;
+		counters.inputLatencyMilliseconds = latencyMilliseconds;
+	});
+}
+
+
+void InputProcessSamples()
+{
+	const bool isFocused = xrSessionState == XR_SESSION_STATE_FOCUSED;
+
+	InputSample sample;
+	while (inputSamples.Pop(sample))
+	{
+		for (uint32_t handIndex = 0; handIndex < 2; handIndex++)
+		{
+			xrBool_IsHandPoseActive[handIndex] = sample.isHandPoseActive[handIndex];
+
+
+			// Keep a short history of the hand to interpolate from
+			{
+				if (sample.isHandPoseValid[handIndex])
+				{
+					PoseHistoryAdd(handPoseHistories[handIndex], sample.time, *(const Pose*)&sample.handPoses[handIndex]);
+				}
+			}
+
+
+			// Add new cube to the scene where the hand was at the moment select went down, not where it was when the frame noticed
+			{
+				Pose pose;
+				if (isFocused && sample.isSelectPressed[handIndex] && PoseHistorySample(handPoseHistories[handIndex], sample.selectPressTimes[handIndex], pose))
+				{
+					ScenePlaceCube(scene, pose);
+					InputReportPlacement(sample.selectPressTimes[handIndex]);
+				}
+			}
+		}
+	}
+}
+
+
+// Everything that belongs to the session, the instance, action set, graphics device and scene stay
+void OpenXRDestroySession()
+{
+	// We used a graphics API to initialize the swapchain data, so we'll
+	// give it a chance to release anythig here!
+	for (int32_t i = 0; i < SwapchainsInfo.size(); i++) 
+	{
+		renderBackend->DestroySwapchainImages(i);
+		xrDestroySwapchain(SwapchainsInfo[i].xrSwapchainHandle);
+		if (SwapchainsInfo[i].xrDepthSwapchainHandle != XR_NULL_HANDLE)
+		{
+			xrDestroySwapchain(SwapchainsInfo[i].xrDepthSwapchainHandle);
+		}
+	}
+
+	SwapchainsInfo.clear();
+	layerProjectionRendered = false;
+
+	// Release all the other OpenXR resources that we've created!
+	// What gets allocated, must get deallocated!
+	locatedSpaces.clear();
+	spaceLocations.clear();
+
+	for (XrSpace& handSpace : xrSpace_Hands)
+	{
+		if (handSpace != XR_NULL_HANDLE) xrDestroySpace(handSpace);
+		handSpace = XR_NULL_HANDLE;
+	}
+
+	if (xrSpace != XR_NULL_HANDLE) xrDestroySpace(xrSpace);
+	if (xrSession != XR_NULL_HANDLE) xrDestroySession(xrSession);
+	xrSpace = XR_NULL_HANDLE;
+	xrSession = XR_NULL_HANDLE;
+	xrSessionState = XR_SESSION_STATE_UNKNOWN;
+}
+
+
+// The runtime lost the session, e.g. because the headset was unplugged. Instead of quitting, destroy what belongs to
+// the session and recreate it in OpenXRRecoverSession, keeping the instance, the device with its resources and the scene
+void OpenXRSessionLost()
+{
+	printf("Session lost, recreating it once the system is available again\n");
+
+	IsXrSessionRunning = false;
+	InputThreadStop();
+	OpenXRDestroySession();
+
+	sessionLost = true;
+	sessionRecovering = true;
+	sessionFrameCount = 0;
+	telemetryPendingPlacements.clear();
+	sessionLossTime = chrono::steady_clock::now();
+	sessionRecoveryNextAttempt = sessionLossTime;
+	telemetryLastDisplayTime = 0;
+	TelemetryWriteCounters([](TelemetryCounters& counters) { counters.sessionLossCount++; });
+}
+
+
+void OpenXRRecoverSession(bool& exit)
+{
+	// xrGetSystem fails until the runtime can reach the headset again, ask at most once per retry interval
+	{
+		const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		if (now < sessionRecoveryNextAttempt)
+		{
+			return;
+		}
+		sessionRecoveryNextAttempt = now + sessionRecoveryRetryInterval;
+
+		XrSystemGetInfo systemInfo = { XR_TYPE_SYSTEM_GET_INFO };
+		systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+		XrSystemId systemId = XR_NULL_SYSTEM_ID;
+		if (XR_FAILED(xrGetSystem(xrInstance, &systemInfo, &systemId)))
+		{
+			return;
+		}
+
+		// The device was created for the old system, a different one would need a new device
+		if (systemId != xrSystemId)
+		{
+			printf("A different system is available after the session loss, the graphics device can not be kept\n");
+			exit = true;
+			return;
+		}
+	}
+
+
+	// Session, spaces and swapchains on the existing device, the action set is attached to the new session again
+	{
+		if (!OpenXRCreateSession() || !OpenXRCreateSwapchains())
+		{
+			printf("Session could not be recreated, retrying\n");
+			OpenXRDestroySession();
+			return;
+		}
+
+		sessionLost = false;
+		printf("Session recreated after %.1f ms, waiting for it to be ready\n", chrono::duration<double, milli>(chrono::steady_clock::now() - sessionLossTime).count());
+	}
+}
+
+
+void OpenXRProcessEvents(bool& exit) 
+{
+	// Test hook, pretend the runtime lost the session every few frames to exercise recovery without a runtime that does
+	{
+		if (sessionLossInjectionFrames > 0 && sessionRecoveryEnabled && sessionFrameCount >= (uint32_t)sessionLossInjectionFrames)
+		{
+			printf("Injecting a session loss\n");
+			OpenXRSessionLost();
+			return;
+		}
+	}
+
+
+	XrEventDataBuffer eventData = { XR_TYPE_EVENT_DATA_BUFFER };
+
+	// Process all OpenXR events
+	while (xrPollEvent(xrInstance, &eventData) == XR_SUCCESS) 
+	{
+		// We are mainly interested in Session state changes
+		switch (eventData.type) 
+		{
 		case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED: // Session state change is where we can begin and end sessions, as well as find quit messages!
 		{
 			XrEventDataSessionStateChanged* stateChangedEventData = (XrEventDataSessionStateChanged*)&eventData;
+			if (stateChangedEventData->session != xrSession) // still queued for a session lost before
+			{
+				break;
+			}
 			xrSessionState = stateChangedEventData->state;
 
 			switch (xrSessionState) 
@@ -633,10 +1140,12 @@ void OpenXRProcessEvents(bool& exit)
 				xrSessionBeginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
 				xrBeginSession(xrSession, &xrSessionBeginInfo);
 				IsXrSessionRunning = true;
+				InputThreadStart();
 			} break;
 
 			case XR_SESSION_STATE_STOPPING: {
 				IsXrSessionRunning = false;
+				InputThreadStop();
 				xrEndSession(xrSession);
 			} break;
 
@@ -644,7 +1153,12 @@ void OpenXRProcessEvents(bool& exit)
 				exit = true;              
 				return;
 
-			case XR_SESSION_STATE_LOSS_PENDING: // Exit main loop and quit if session lost
+			case XR_SESSION_STATE_LOSS_PENDING: // Recreate the session if it was lost, or exit main loop and quit
+				if (sessionRecoveryEnabled)
+				{
+					OpenXRSessionLost();
+					break;
+				}
 				exit = true;              
 				return;
 			}
@@ -662,6 +1176,15 @@ void OpenXRProcessEvents(bool& exit)
 
 void OpenXRPollActions() 
 { 
+	// With the input thread running, actions are already sampled, only take over what it published since the last frame
+	{
+		if (inputThreadRunning)
+		{
+			InputProcessSamples();
+			return;
+		}
+	}
+
 	// Actions only processed if session focused
 	{
 		if (xrSessionState != XR_SESSION_STATE_FOCUSED)
@@ -711,14 +1234,17 @@ void OpenXRPollActions()
 
 		// Add new cube to the scene if new select action detected
 		{
-			if (handSelectState.currentState && handSelectState.changedSinceLastSync)
+			PressLatch selectPress;
+			PressLatchUpdate(selectPress, handSelectState.currentState, handSelectState.changedSinceLastSync, handSelectState.lastChangeTime);
+			if (selectPress.pressed)
 			{
 				XrSpaceLocation handSpaceLocation = { XR_TYPE_SPACE_LOCATION };
-				if (XR_UNQUALIFIED_SUCCESS(xrLocateSpace(xrSpace_Hands[handIndex], xrSpace, handSelectState.lastChangeTime, &handSpaceLocation)) &&
+				if (XR_UNQUALIFIED_SUCCESS(xrLocateSpace(xrSpace_Hands[handIndex], xrSpace, selectPress.time, &handSpaceLocation)) &&
 					(handSpaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
 					(handSpaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0)
 				{
-					cubes.push_back(handSpaceLocation.pose); // add hand pose in the past to cube, as this happened in the past, we know where hand was
+					ScenePlaceCube(scene, *(const Pose*)&handSpaceLocation.pose); // add hand pose in the past to cube, as this happened in the past, we know where hand was
+					InputReportPlacement(selectPress.time);
 				}
 			}
 		}
@@ -726,23 +1252,8 @@ void OpenXRPollActions()
 }
 
 
-void OpenXRRenderFrame()
+void OpenXRUpdateHandCubes()
 {
-	XrFrameState frameState = { XR_TYPE_FRAME_STATE };
-
-
-	// Wait for previous frame finished displaying and a prediction of when the next frame will be displayed, used for pose prediction
-	{
-		xrWaitFrame(xrSession, nullptr, &frameState);
-	}
-
-
-	// Sinalize we are about to start rendering. This can return some interesting flags like XR_SESSION_VISIBILITY_UNAVAILABLE
-	{
-		xrBeginFrame(xrSession, nullptr);
-	}
-
-
 	// Use predicted display time to update cube poses to follow hands if session has focus and can receive user input
 	{
 		if (xrSessionState == XR_SESSION_STATE_FOCUSED)
@@ -755,11 +1266,10 @@ void OpenXRRenderFrame()
 				}
 
 
-				// Get predicted hand pose by locating hand space on predicted time for acurate location and reduced perceived lag
+				// Get predicted hand pose from the hand space located on predicted time for acurate location and reduced perceived lag
 				{
-					XrSpaceLocation handSpaceLocation = { XR_TYPE_SPACE_LOCATION };
-					if (XR_UNQUALIFIED_SUCCESS(xrLocateSpace(xrSpace_Hands[handIndex], xrSpace, frameState.predictedDisplayTime, &handSpaceLocation)) &&
-						(handSpaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
+					const XrSpaceLocationDataKHR& handSpaceLocation = spaceLocations[locatedSpaceIndex_Hands[handIndex]];
+					if ((handSpaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
 						(handSpaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0)
 					{
 						xrPosef_Hands[handIndex] = handSpaceLocation.pose;
@@ -772,51 +1282,193 @@ void OpenXRRenderFrame()
 			// Update the predicted poses of the cubes attached to the hands to match predicted hand poses
 			for (size_t handIndex = 0; handIndex < 2; handIndex++)
 			{
-				cubes[handIndex] = xrBool_IsHandPoseActive[handIndex] ? xrPosef_Hands[handIndex] : POSE_IDENTITY;
+				SceneSetHandCube(scene, handIndex, xrBool_IsHandPoseActive[handIndex] ? *(const Pose*)&xrPosef_Hands[handIndex] : poseIdentity);
 			}
 		}
 	}
+}
+
+
+// Whether the head, the hands or the scene moved since the previous frame by more than reprojection hides well
+bool OpenXRDetectMotion(XrDuration displayPeriod)
+{
+	const float seconds = displayPeriod > 0 ? (float)displayPeriod / 1e9f : 1.0f / 60.0f;
+	const float maxDistance = framePacingMaxSpeed * seconds;
+	const float maxAngle = framePacingMaxAngularSpeed * seconds;
+	bool moved = false;
+
+
+	// Cubes placed, or a different set of views
+	{
+		moved = scene.cubes.size() != framePacingCubeCount || framePacingViewPoses.size() != viewCount;
+		framePacingCubeCount = scene.cubes.size();
+		framePacingViewPoses.resize(viewCount);
+	}
+
+
+	// Head, through the pose of every view
+	for (uint32_t i = 0; i < viewCount; i++)
+	{
+		const Pose& pose = *(const Pose*)&xrViews[i].pose;
+		moved = moved || !PoseWithinTolerance(framePacingViewPoses[i], pose, maxDistance, maxAngle);
+		framePacingViewPoses[i] = pose;
+	}
+
+
+	// Hands, each of them carries a cube
+	for (uint32_t handIndex = 0; handIndex < 2; handIndex++)
+	{
+		Pose pose = framePacingHandPoses[handIndex];
+		const XrSpaceLocationDataKHR& handSpaceLocation = spaceLocations[locatedSpaceIndex_Hands[handIndex]];
+		if ((handSpaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
+			(handSpaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0)
+		{
+			pose = *(const Pose*)&handSpaceLocation.pose;
+		}
+
+		moved = moved || xrBool_IsHandPoseActive[handIndex] != framePacingHandActive[handIndex] ||
+			(xrBool_IsHandPoseActive[handIndex] && !PoseWithinTolerance(framePacingHandPoses[handIndex], pose, maxDistance, maxAngle));
+		framePacingHandActive[handIndex] = xrBool_IsHandPoseActive[handIndex];
+		framePacingHandPoses[handIndex] = pose;
+	}
+
+	return moved;
+}
+
+
+void OpenXRRenderFrame()
+{
+	XrFrameState frameState = { XR_TYPE_FRAME_STATE };
+	const chrono::steady_clock::time_point waitFrameStart = chrono::steady_clock::now();
+	chrono::steady_clock::time_point frameStart;
+
+
+	// Wait for previous frame finished displaying and a prediction of when the next frame will be displayed, used for pose prediction
+	{
+		xrWaitFrame(xrSession, nullptr, &frameState);
+		frameStart = chrono::steady_clock::now();
+	}
+
+
+	// Locate hands and every other registered space at the predicted display time in one batch, the time it happened
+	// starts the motion to photon latency of the hand cubes
+	XrTime spacesLocateTime = 0;
+	{
+		OpenXRLocateSpaces(frameState.predictedDisplayTime);
+		if (!OpenXRGetCurrentTime(spacesLocateTime))
+		{
+			spacesLocateTime = 0;
+		}
+	}
+
+
+	// Sinalize we are about to start rendering. This can return some interesting flags like XR_SESSION_VISIBILITY_UNAVAILABLE
+	{
+		xrBeginFrame(xrSession, nullptr);
+	}
 
 
 	XrCompositionLayerBaseHeader* layer = nullptr;
-	XrCompositionLayerProjection layerProjection = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
-	vector<XrCompositionLayerProjectionView> layerProjectionViews;
+	const bool isVisible = xrSessionState == XR_SESSION_STATE_VISIBLE || xrSessionState == XR_SESSION_STATE_FOCUSED;
+
+
+	// Locate each viewpoint at the predicted time
+	if (isVisible)
+	{
+		uint32_t viewCount;
+		XrViewState viewState = { XR_TYPE_VIEW_STATE };
+		XrViewLocateInfo viewLocateInfo = { XR_TYPE_VIEW_LOCATE_INFO };
+		viewLocateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+		viewLocateInfo.displayTime = frameState.predictedDisplayTime;
+		viewLocateInfo.space = xrSpace;
+
+		xrLocateViews(xrSession, &viewLocateInfo, &viewState, (uint32_t)xrViews.size(), &viewCount, xrViews.data());
+		layerProjectionViews.resize(viewCount);
+		layerDepthInfos.resize(viewCount);
+	}
+
+
+	// When nothing moved for a while, submit the last rendered layer again every other frame and let the runtime reproject it
+	bool reprojected = false;
+	{
+		if (!isVisible)
+		{
+			layerProjectionRendered = false;
+			FramePacingReset(framePacing);
+		}
+		else if (framePacingEnabled)
+		{
+			const bool moved = OpenXRDetectMotion(frameState.predictedDisplayPeriod);
+			reprojected = !FramePacingShouldRender(framePacing, moved || !layerProjectionRendered);
+		}
+
+		if (reprojected)
+		{
+			layer = (XrCompositionLayerBaseHeader*)&layerProjection;
+		}
+	}
 
 
 	// Lets render our views if session visible
-	if (xrSessionState == XR_SESSION_STATE_VISIBLE || xrSessionState == XR_SESSION_STATE_FOCUSED)
+	if (isVisible && !reprojected)
 	{
-		// Locate each viewpoint at the predicted time
+		// Set up view projection matrix of every viewpoint based on predicted camera pose information
 		{
-			uint32_t viewCount;
-			XrViewState viewState = { XR_TYPE_VIEW_STATE };
-			XrViewLocateInfo viewLocateInfo = { XR_TYPE_VIEW_LOCATE_INFO };
-			viewLocateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
-			viewLocateInfo.displayTime = frameState.predictedDisplayTime;
-			viewLocateInfo.space = xrSpace;
+			frameJobs.viewProjections.resize(viewCount);
+			for (uint32_t i = 0; i < viewCount; i++)
+			{
+				Float4x4 ProjectionMatrix = renderBackend->GetProjectionMatrix(xrViews[i].fov, clipNear, clipFar);
+				Float4x4 ViewMatrix = MatrixInverseRigid(MatrixFromPose(*(const Pose*)&xrViews[i].pose, 1.0f));
 
-			xrLocateViews(xrSession, &viewLocateInfo, &viewState, (uint32_t)xrViews.size(), &viewCount, xrViews.data());
-			layerProjectionViews.resize(viewCount);
+				frameJobs.viewProjections[i] = MatrixMultiply(ViewMatrix, ProjectionMatrix);
+			}
 		}
 
 
-		// Render views from each viewpoint
+		// Start the scene jobs of the frame: hand cube poses, cube transforms, then frustum and occlusion culling and draw list recording per view
+		JobCounter frameJobsDone;
+		{
+			frameJobs.updatePoses = OpenXRUpdateHandCubes;
+			frameJobs.poses = scene.cubes.data();
+			frameJobs.poseCount = scene.cubes.size();
+			frameJobs.scale = cubeScale;
+			frameJobs.boundingRadius = cubeBoundingRadius;
+			frameJobs.occlusionCulling = occlusionCullingEnabled;
+			FrameJobsRun(frameJobs, frameJobsDone);
+		}
+
+
+		// Meanwhile get the swapchain images of every viewpoint ready
+		vector<uint32_t> imageIds(viewCount);
+		vector<uint32_t> depthImageIds(viewCount);
 		for (uint32_t i = 0; i < viewCount; i++) 
 		{
-			uint32_t imageId;
+			const XrSwapchain depthSwapchain = SwapchainsInfo[i].xrDepthSwapchainHandle;
 
-			// Ask runtime which swapchain image is next for rendering 
+
+			// Ask runtime which swapchain images are next for rendering, without a depth swapchain the backend's depth buffer goes with the color image
 			{
 				XrSwapchainImageAcquireInfo imageAcquireInfo = { XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
-				xrAcquireSwapchainImage(SwapchainsInfo[i].xrSwapchainHandle, &imageAcquireInfo, &imageId);
+				xrAcquireSwapchainImage(SwapchainsInfo[i].xrSwapchainHandle, &imageAcquireInfo, &imageIds[i]);
+
+				depthImageIds[i] = imageIds[i];
+				if (depthSwapchain != XR_NULL_HANDLE)
+				{
+					xrAcquireSwapchainImage(depthSwapchain, &imageAcquireInfo, &depthImageIds[i]);
+				}
 			}
 
 
-			// Wait until the image is ready to render to
+			// Wait until the images are ready to render to
 			{
 				XrSwapchainImageWaitInfo imageWaitInfo = { XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
 				imageWaitInfo.timeout = XR_INFINITE_DURATION;
 				xrWaitSwapchainImage(SwapchainsInfo[i].xrSwapchainHandle, &imageWaitInfo);
+
+				if (depthSwapchain != XR_NULL_HANDLE)
+				{
+					xrWaitSwapchainImage(depthSwapchain, &imageWaitInfo);
+				}
 			}
 
 
@@ -830,85 +1482,46 @@ void OpenXRRenderFrame()
 				layerProjectionViews[i].subImage.imageRect.extent = { SwapchainsInfo[i].width, SwapchainsInfo[i].height };
 			}
 
-			
-			// Set D3D viewport we will render onto with same swapchain image dimension
-			{
-				XrRect2Di& rect = layerProjectionViews[i].subImage.imageRect;
-				D3D11_VIEWPORT viewport = CD3D11_VIEWPORT((float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height);
-				d3dContext->RSSetViewports(1, &viewport);
-			}
-
-
-			// Clear swapchain color and depth views, and set them up for rendering on d3D rendering pipeline
-			{
-				float clear[] = { 0, 0, 0, 1 };
-				d3dContext->ClearRenderTargetView(SwapchainsInfo[i].renderTargetViews[imageId], clear);
-				d3dContext->ClearDepthStencilView(SwapchainsInfo[i].depthStencilViews[imageId], D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-				d3dContext->OMSetRenderTargets(1, &SwapchainsInfo[i].renderTargetViews[imageId], SwapchainsInfo[i].depthStencilViews[imageId]);
-			}
 
-                                
-			// Set the active shaders and constant buffers on Vector and Pixel Shader stages of D3D rendering pipeline
+			// Attach the depth of the view, depth 0 is at clipNear and 1 at clipFar with the projection from the render backend
 			{
-				ID3D11Buffer* const constantBuffers[] = { modelConstantBuffer , viewProjectionConstantBuffer };
-				d3dContext->VSSetConstantBuffers(0, (UINT)std::size(constantBuffers), constantBuffers);
-				d3dContext->VSSetShader(vertexShader, nullptr, 0);
-				d3dContext->PSSetShader(pixelShader, nullptr, 0);
+				if (depthSwapchain != XR_NULL_HANDLE)
+				{
+					layerDepthInfos[i] = { XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR };
+					layerDepthInfos[i].subImage.swapchain = depthSwapchain;
+					layerDepthInfos[i].subImage.imageRect = layerProjectionViews[i].subImage.imageRect;
+					layerDepthInfos[i].minDepth = 0.0f;
+					layerDepthInfos[i].maxDepth = 1.0f;
+					layerDepthInfos[i].nearZ = clipNear;
+					layerDepthInfos[i].farZ = clipFar;
+					layerProjectionViews[i].next = &layerDepthInfos[i];
+				}
 			}
+		}
 
 
-			//	Hook cube mesh triangles data, the vertex buffer and index buffer on Input Assembly stage of D3D rendering pipeline
-			{
-				UINT strides[] = { sizeof(float) * 6 };
-				UINT offsets[] = { 0 };
-				d3dContext->IASetVertexBuffers(0, 1, &vertexBuffer, strides, offsets);
-				d3dContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R16_UINT, 0);
-				d3dContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-				d3dContext->IASetInputLayout(inputLayout);
-			}
-
-                               
-			// Set up view projection matrix based on predicted camera pose information and update shader's view projection constant buffer
-			{
-				XMMATRIX ProjectionMatrix = D3DGetProjectionMatrix(layerProjectionViews[i].fov, 0.05f, 100.0f);
-				XMMATRIX ViewMatrix = XMMatrixInverse(nullptr,
-					XMMatrixAffineTransformation
-					(
-						DirectX::g_XMOne,
-						DirectX::g_XMZero,
-						XMLoadFloat4((XMFLOAT4*)&layerProjectionViews[i].pose.orientation),
-						XMLoadFloat3((XMFLOAT3*)&layerProjectionViews[i].pose.position)
-					));
-
-
-				ViewProjectionConstantBuffer viewproj;
-				XMStoreFloat4x4(&viewproj.ViewProjection, XMMatrixTranspose(ViewMatrix * ProjectionMatrix));
-				d3dContext->UpdateSubresource(viewProjectionConstantBuffer, 0, nullptr, &viewproj, 0, 0);
-			}
+		// Draw lists are needed from here on, help the job threads finish them
+		{
+			JobWait(frameJobsDone);
+		}
 
 
-			// Set up model transform matrix for every cube in the stack with updated cube pose, update shader's model contant buffer and draw cube triangles                  
+		// Render views from each viewpoint
+		for (uint32_t i = 0; i < viewCount; i++) 
+		{
+			// Let the render backend clear the swapchain image and draw the cubes visible in this view onto it
 			{
-				ModelConstantBuffer model;
-
-				for (size_t i = 0; i < cubes.size(); i++)
-				{
-					XMMATRIX ModelMatrix = XMMatrixAffineTransformation(
-						DirectX::g_XMOne * 0.05f, DirectX::g_XMZero,
-						XMLoadFloat4((XMFLOAT4*)&cubes[i].orientation),
-						XMLoadFloat3((XMFLOAT3*)&cubes[i].position));
-
-
-					XMStoreFloat4x4(&model.Model, XMMatrixTranspose(ModelMatrix));
-					d3dContext->UpdateSubresource(modelConstantBuffer, 0, nullptr, &model, 0, 0);
-					d3dContext->DrawIndexed((UINT)_countof(cubeIndices), 0, 0);
-				}
+				renderBackend->RenderView(i, imageIds[i], depthImageIds[i], layerProjectionViews[i].subImage.imageRect, frameJobs.viewProjections[i], frameJobs.drawLists[i]);
 			}
 
 
 			// Tell runtime we are finished with rendering to this swapchain image
 			XrSwapchainImageReleaseInfo release_info = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
 			xrReleaseSwapchainImage(SwapchainsInfo[i].xrSwapchainHandle, &release_info);
+			if (SwapchainsInfo[i].xrDepthSwapchainHandle != XR_NULL_HANDLE)
+			{
+				xrReleaseSwapchainImage(SwapchainsInfo[i].xrDepthSwapchainHandle, &release_info);
+			}
 		}
 
 
@@ -920,6 +1533,10 @@ void OpenXRRenderFrame()
 
 
 			layer = (XrCompositionLayerBaseHeader*)&layerProjection;
+			layerProjectionRendered = true;
+
+			const bool handCubesShown = xrSessionState == XR_SESSION_STATE_FOCUSED && (xrBool_IsHandPoseActive[0] || xrBool_IsHandPoseActive[1]);
+			telemetryLayerHandLocateTime = handCubesShown ? spacesLocateTime : 0;
 		}
 	}
 
@@ -933,47 +1550,168 @@ void OpenXRRenderFrame()
 		end_info.layers = &layer;
 		xrEndFrame(xrSession, &end_info);
 	}
-}
 
 
-void OpenXRShutdown() 
-{
-	// We used a graphics API to initialize the swapchain data, so we'll
-	// give it a chance to release anythig here!
-	for (int32_t i = 0; i < SwapchainsInfo.size(); i++) 
+	// Publish the frame to telemetry. Display periods between this frame's predicted display time and the previous one's were missed
 	{
-		xrDestroySwapchain(SwapchainsInfo[i].xrSwapchainHandle);
-		D3DDestroySwapchain(SwapchainsInfo[i]);
+		TelemetryFrameRecord record = {};
+		record.predictedDisplayTime = frameState.predictedDisplayTime;
+		record.frameMilliseconds = chrono::duration<float, milli>(chrono::steady_clock::now() - frameStart).count();
+		record.waitFrameMilliseconds = chrono::duration<float, milli>(frameStart - waitFrameStart).count();
+		record.cubeCount = (uint32_t)scene.cubes.size();
+		record.rendered = layer != nullptr ? 1 : 0;
+		record.reprojected = reprojected ? 1 : 0;
+
+		if (layer != nullptr && !reprojected)
+		{
+			for (const vector<Float4x4>& drawList : frameJobs.drawLists)
+			{
+				record.drawCallCount += (uint32_t)drawList.size();
+			}
+			for (const FrameJobsViewStats& viewStats : frameJobs.viewStats)
+			{
+				record.occludedCount += viewStats.occludedCount;
+				record.occluderCount += viewStats.occluderCount;
+				record.occlusionMilliseconds += (float)viewStats.occlusionMilliseconds;
+			}
+		}
+
+		if (telemetryLastDisplayTime != 0 && frameState.predictedDisplayPeriod > 0)
+		{
+			const XrTime periods = (frameState.predictedDisplayTime - telemetryLastDisplayTime + frameState.predictedDisplayPeriod / 2) / frameState.predictedDisplayPeriod;
+			record.missedFrameCount = periods > 1 ? (uint32_t)(periods - 1) : 0;
+		}
+		telemetryLastDisplayTime = frameState.predictedDisplayTime;
+
+
+		// Latencies until the predicted display time. New cubes are in the scene from the first rendered frame after
+		// their placement, hand cubes are as old as the poses of the layer, so older again in reprojected frames
+		const uint32_t latencyModes =
+			(inputThreadRunning ? telemetryModeInputThread : 0) |
+			(JobSystemThreadCount() > 1 ? telemetryModeJobThreads : 0) |
+			(occlusionCullingEnabled ? telemetryModeOcclusionCulling : 0) |
+			(framePacingEnabled ? telemetryModeHalfRate : 0) |
+			(depthLayerExtensionEnabled && depthSwapchainFormatSupported ? telemetryModeDepthLayer : 0);
+		const bool latencyModesChanged = latencyModes != telemetryLatencyModes;
+		telemetryLatencyModes = latencyModes;
+
+		vector<double> placementMilliseconds;
+		if (layer != nullptr && !reprojected)
+		{
+			for (XrTime pressTime : telemetryPendingPlacements)
+			{
+				placementMilliseconds.push_back((double)(frameState.predictedDisplayTime - pressTime) / 1e6);
+			}
+			telemetryPendingPlacements.clear();
+		}
+
+		const double motionToPhotonMilliseconds = layer != nullptr && telemetryLayerHandLocateTime != 0 ? (double)(frameState.predictedDisplayTime - telemetryLayerHandLocateTime) / 1e6 : -1.0;
+
+		TelemetryWriteFrameRecord(record);
+		TelemetryWriteCounters([&](TelemetryCounters& counters)
+		{
+			counters.frameCount++;
+			counters.renderedFrameCount += record.rendered && !record.reprojected ? 1 : 0;
+			counters.reprojectedFrameCount += record.reprojected;
+			counters.missedFrameCount += record.missedFrameCount;
+			counters.frameMilliseconds = record.frameMilliseconds;
+			counters.displayPeriodMilliseconds = (double)frameState.predictedDisplayPeriod / 1e6;
+			counters.cubeCount = record.cubeCount;
+			counters.drawCallCount = record.drawCallCount;
+			counters.sessionState = (uint32_t)xrSessionState;
+			counters.occludedCount = record.occludedCount;
+			counters.occluderCount = record.occluderCount;
+			counters.occlusionMilliseconds = record.occlusionMilliseconds;
+
+			if (latencyModesChanged)
+			{
+				counters.latencyModes = latencyModes;
+				counters.placementLatency = {};
+				counters.handMotionToPhoton = {};
+			}
+			for (double milliseconds : placementMilliseconds)
+			{
+				TelemetryHistogramAdd(counters.placementLatency, milliseconds);
+			}
+			if (motionToPhotonMilliseconds >= 0.0)
+			{
+				TelemetryHistogramAdd(counters.handMotionToPhoton, motionToPhotonMilliseconds);
+			}
+		});
 	}
 
-	SwapchainsInfo.clear();
 
-	// Release all the other OpenXR resources that we've created!
-	// What gets allocated, must get deallocated!
-	if (xrActionSet != XR_NULL_HANDLE) 
+	// Report the startup timeline once the first frame with content has been handed to the runtime
 	{
-		if (xrSpace_Hands[0] != XR_NULL_HANDLE) xrDestroySpace(xrSpace_Hands[0]);
-		if (xrSpace_Hands[1] != XR_NULL_HANDLE) xrDestroySpace(xrSpace_Hands[1]);
-		xrDestroyActionSet(xrActionSet);
+		if (layer != nullptr && startupFirstFrameTime == chrono::steady_clock::time_point())
+		{
+			startupFirstFrameTime = chrono::steady_clock::now();
+			StartupReportTimeline();
+
+			const double firstFrameMilliseconds = chrono::duration<double, milli>(startupFirstFrameTime - startupTime).count();
+			TelemetryWriteCounters([firstFrameMilliseconds](TelemetryCounters& counters) { counters.firstFrameMilliseconds = firstFrameMilliseconds; });
+		}
 	}
 
-	if (xrSpace != XR_NULL_HANDLE) xrDestroySpace(xrSpace);
-	if (xrSession != XR_NULL_HANDLE) xrDestroySession(xrSession);
+
+	// Report how long it took from a session loss until content was shown again
+	{
+		if (layer != nullptr && sessionRecovering)
+		{
+			sessionRecovering = false;
+			const double recoveryMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - sessionLossTime).count();
+			printf("Recovered from session loss in %.1f ms\n", recoveryMilliseconds);
+			TelemetryWriteCounters([recoveryMilliseconds](TelemetryCounters& counters) { counters.sessionRecoveryMilliseconds = recoveryMilliseconds; });
+		}
+	}
+}
+
+
+void OpenXRShutdown() 
+{
+	InputThreadStop();
+	OpenXRDestroySession();
+
+	if (xrActionSet != XR_NULL_HANDLE) xrDestroyActionSet(xrActionSet);
 	if (xrInstance != XR_NULL_HANDLE) xrDestroyInstance(xrInstance);
 }
 
 
+RenderBackend* CreateRenderBackend()
+{
+#ifdef OPENXR_EXAMPLE_BACKEND_VULKAN
+	return CreateVulkanRenderBackend();
+#else
+	return CreateD3D11RenderBackend();
+#endif
+}
+
+
                        
+#ifdef _WIN32
 int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
+#else
+int main()
+#endif
 {
+	renderBackend = CreateRenderBackend();
+	SceneInitialize(scene);
+
+	if (OptionEnabled("OPENXR_EXAMPLE_TELEMETRY", true) && !TelemetryCreate())
+	{
+		printf("Telemetry shared memory could not be created, running without telemetry\n");
+	}
+	JobSystemInitialize(OptionEnabled("OPENXR_EXAMPLE_JOB_THREADS", true) ? 0 : 1);
+
 	if (!OpenXRInitialize()) 
 	{
-		D3DShutdown();
+		renderBackend->Shutdown();
+		delete renderBackend;
+		JobSystemShutdown();
+		TelemetryDestroy();
 		return 1;
 	}
 
-	D3DInitializeResources();
-
 	bool exit = false;
 	while (!exit) 
 	{
@@ -983,15 +1721,25 @@ int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
 		{
 			OpenXRPollActions();
 			OpenXRRenderFrame();
+			sessionFrameCount++;
 		}
 		else
 		{
+			// Recreate a lost session once the system is back
+			if (sessionLost)
+			{
+				OpenXRRecoverSession(exit);
+			}
+
 			// Throttle loop when wait frame is not called
 			this_thread::sleep_for(chrono::milliseconds(250));
 		}
 	}
 
 	OpenXRShutdown();
-	D3DShutdown();
+	renderBackend->Shutdown();
+	delete renderBackend;
+	JobSystemShutdown();
+	TelemetryDestroy();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Simd.h"
+
+using namespace std;
+
+
+// Occluder depths are pushed back a little, so rounding never lets an occluder hide a cube at the same depth,
+// including itself
+const float occlusionDepthBias = 1e-5f;
+
+// Texels an occluder covers are shrunk by a little more than half a texel, so edges the GPU rasterizes a bit
+// differently than this rasterizer never count as covered
+const float occlusionCoverageMargin = 0.51f;
+
+// Corners of the cube's box, bit 0 to 2 of the index select the x, y and z sign
+const uint8_t occlusionCubeFaces[6][4] = {
+	{ 0, 2, 6, 4 }, // -x
+	{ 1, 3, 7, 5 }, // +x
+	{ 0, 1, 5, 4 }, // -y
+	{ 2, 3, 7, 6 }, // +y
+	{ 0, 1, 3, 2 }, // -z
+	{ 4, 5, 7, 6 }, // +z
+};
+
+// Corner after the perspective divide, in texels of level 0 and depth
+struct OcclusionVertex {
+	float x, y, z;
+};
+
+
+////////////////////////////////////////////////
+// Occluders
+////////////////////////////////////////////////
+
+bool OcclusionProjectCube(const Float4x4& viewProjection, const Float4x4& model, OcclusionVertex corners[8])
+{
+	// The box corners are the translation row plus or minus the other rows, so they only take additions
+	const Float4x4 modelViewProjection = MatrixMultiply(model, viewProjection);
+	const float (&m)[4][4] = modelViewProjection.m;
+
+	for (int i = 0; i < 8; i++)
+	{
+		const float sx = i & 1 ? 1.0f : -1.0f;
+		const float sy = i & 2 ? 1.0f : -1.0f;
+		const float sz = i & 4 ? 1.0f : -1.0f;
+
+		float clip[4];
+		for (int c = 0; c < 4; c++)
+		{
+			clip[c] = m[3][c] + sx * m[0][c] + sy * m[1][c] + sz * m[2][c];
+		}
+
+		// Corners in front of the near plane have no meaningful screen position
+		if (!(clip[3] > 0) || clip[2] < 0)
+		{
+			return false;
+		}
+
+		const float inverseW = 1.0f / clip[3];
+		corners[i].x = (clip[0] * inverseW * 0.5f + 0.5f) * occlusionWidth;
+		corners[i].y = (0.5f - clip[1] * inverseW * 0.5f) * occlusionHeight;
+		corners[i].z = clip[2] * inverseW;
+	}
+	return true;
+}
+
+
+void OcclusionRasterizeQuad(OcclusionBuffer& buffer, const OcclusionVertex* v0, const OcclusionVertex* v1, const OcclusionVertex* v2, const OcclusionVertex* v3)
+{
+	// Back faces are rasterized as well, their winding depends on the projection and they are behind the front faces anyway
+	float area = (v1->x - v0->x) * (v2->y - v0->y) - (v2->x - v0->x) * (v1->y - v0->y);
+	if (!(fabsf(area) > 1e-6f))
+	{
+		return;
+	}
+	if (area < 0)
+	{
+		swap(v1, v3);
+		area = -area;
+	}
+	const OcclusionVertex* vertices[4] = { v0, v1, v2, v3 };
+
+
+	// Edge functions that are positive where the whole texel around a texel center is inside of the quad
+	float edgeA[4], edgeB[4], edgeC[4];
+	for (int i = 0; i < 4; i++)
+	{
+		const OcclusionVertex& a = *vertices[i];
+		const OcclusionVertex& b = *vertices[(i + 1) & 3];
+		edgeA[i] = a.y - b.y;
+		edgeB[i] = b.x - a.x;
+		edgeC[i] = -(edgeA[i] * a.x + edgeB[i] * a.y) - occlusionCoverageMargin * (fabsf(edgeA[i]) + fabsf(edgeB[i]));
+	}
+
+
+	// Depth plane, linear in screen space, raised to the farthest depth the face has inside of a texel
+	const float depthX = ((v1->z - v0->z) * (v2->y - v0->y) - (v2->z - v0->z) * (v1->y - v0->y)) / area;
+	const float depthY = ((v2->z - v0->z) * (v1->x - v0->x) - (v1->z - v0->z) * (v2->x - v0->x)) / area;
+	const float depthC = v0->z - depthX * v0->x - depthY * v0->y + 0.5f * (fabsf(depthX) + fabsf(depthY)) + occlusionDepthBias;
+
+
+	// Texels the quad's bounds touch, the edge functions reject the ones it does not cover completely
+	const float left = clamp(min({ v0->x, v1->x, v2->x, v3->x }), 0.0f, (float)occlusionWidth);
+	const float top = clamp(min({ v0->y, v1->y, v2->y, v3->y }), 0.0f, (float)occlusionHeight);
+	const float right = clamp(max({ v0->x, v1->x, v2->x, v3->x }), 0.0f, (float)occlusionWidth);
+	const float bottom = clamp(max({ v0->y, v1->y, v2->y, v3->y }), 0.0f, (float)occlusionHeight);
+	const int32_t minX = (int32_t)left & ~3;
+	const int32_t minY = (int32_t)top;
+	const int32_t maxX = (int32_t)ceilf(right) - 1;
+	const int32_t maxY = (int32_t)ceilf(bottom) - 1;
+
+	const SimdFloat zero = SimdSet(0.0f);
+	const SimdFloat laneOffsets = SimdSet(0.5f, 1.5f, 2.5f, 3.5f);
+	SimdFloat edgeAX[4];
+	for (int i = 0; i < 4; i++)
+	{
+		edgeAX[i] = SimdSet(edgeA[i]);
+	}
+	const SimdFloat depthAX = SimdSet(depthX);
+
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		const float pixelY = y + 0.5f;
+
+		// Everything but the x term of the planes is constant along the row
+		SimdFloat edgeRow[4];
+		for (int i = 0; i < 4; i++)
+		{
+			edgeRow[i] = SimdSet(edgeB[i] * pixelY + edgeC[i]);
+		}
+		const SimdFloat depthRow = SimdSet(depthY * pixelY + depthC);
+
+		// Rows are a multiple of 4 texels, so whole SIMD groups can be loaded and stored
+		float* row = &buffer.maxDepth[0][(size_t)y * occlusionWidth];
+		for (int32_t x = minX; x <= maxX; x += 4)
+		{
+			const SimdFloat pixelX = SimdAdd(SimdSet((float)x), laneOffsets);
+			SimdMask inside = SimdGreaterEqual(SimdAdd(SimdMul(edgeAX[0], pixelX), edgeRow[0]), zero);
+			for (int i = 1; i < 4; i++)
+			{
+				inside = SimdAnd(inside, SimdGreaterEqual(SimdAdd(SimdMul(edgeAX[i], pixelX), edgeRow[i]), zero));
+			}
+			if (SimdMoveMask(inside) == 0)
+			{
+				continue;
+			}
+
+			const SimdFloat depth = SimdAdd(SimdMul(depthAX, pixelX), depthRow);
+			const SimdFloat previous = SimdLoad(row + x);
+			SimdStore(row + x, SimdSelect(inside, SimdMin(previous, depth), previous));
+		}
+	}
+}
+
+
+bool OcclusionRasterizeCube(OcclusionBuffer& buffer, const Float4x4& model)
+{
+	// Occluders crossing the near plane are skipped rather than clipped, there are plenty of others
+	OcclusionVertex corners[8];
+	if (!OcclusionProjectCube(buffer.viewProjection, model, corners))
+	{
+		return false;
+	}
+
+	for (const uint8_t* face : occlusionCubeFaces)
+	{
+		OcclusionRasterizeQuad(buffer, &corners[face[0]], &corners[face[1]], &corners[face[2]], &corners[face[3]]);
+	}
+	return true;
+}
+
+
+void OcclusionBuildPyramid(OcclusionBuffer& buffer)
+{
+	float rowMin[occlusionWidth];
+	float rowMax[occlusionWidth];
+
+	for (int32_t level = 1; level < occlusionLevelCount; level++)
+	{
+		const int32_t width = occlusionWidth >> level;
+		const int32_t height = occlusionHeight >> level;
+		const int32_t sourceWidth = width * 2;
+		const float* sourceMin = level == 1 ? buffer.maxDepth[0].data() : buffer.minDepth[level - 1].data();
+		const float* sourceMax = buffer.maxDepth[level - 1].data();
+		float* destinationMin = buffer.minDepth[level].data();
+		float* destinationMax = buffer.maxDepth[level].data();
+
+		for (int32_t y = 0; y < height; y++)
+		{
+			// Vertical pairs 4 texels at a time, then the horizontal pairs
+			const size_t row0 = (size_t)y * 2 * sourceWidth;
+			const size_t row1 = row0 + sourceWidth;
+			for (int32_t x = 0; x < sourceWidth; x += 4)
+			{
+				SimdStore(rowMin + x, SimdMin(SimdLoad(sourceMin + row0 + x), SimdLoad(sourceMin + row1 + x)));
+				SimdStore(rowMax + x, SimdMax(SimdLoad(sourceMax + row0 + x), SimdLoad(sourceMax + row1 + x)));
+			}
+
+			for (int32_t x = 0; x < width; x++)
+			{
+				destinationMin[(size_t)y * width + x] = min(rowMin[x * 2], rowMin[x * 2 + 1]);
+				destinationMax[(size_t)y * width + x] = max(rowMax[x * 2], rowMax[x * 2 + 1]);
+			}
+		}
+	}
+}
+
+
+void OcclusionBegin(OcclusionBuffer& buffer, const Float4x4& viewProjection)
+{
+	buffer.viewProjection = viewProjection;
+	buffer.occluderCandidates.clear();
+	buffer.occluderCount = 0;
+
+	// Sized on first use, later frames only clear level 0, the other levels are rebuilt from it
+	buffer.maxDepth[0].assign((size_t)occlusionWidth * occlusionHeight, 1.0f);
+	for (int32_t level = 1; level < occlusionLevelCount; level++)
+	{
+		const size_t size = (size_t)(occlusionWidth >> level) * (occlusionHeight >> level);
+		buffer.minDepth[level].resize(size);
+		buffer.maxDepth[level].resize(size);
+	}
+}
+
+
+void OcclusionAddOccluderCandidates(OcclusionBuffer& buffer, const Float4x4* models, const uint32_t* indices, size_t count)
+{
+	// Distance along the view direction of the cube's center is its clip space w
+	const float (&viewProjection)[4][4] = buffer.viewProjection.m;
+	for (size_t i = 0; i < count; i++)
+	{
+		const float (&model)[4][4] = models[indices[i]].m;
+		const float w = model[3][0] * viewProjection[0][3] + model[3][1] * viewProjection[1][3] + model[3][2] * viewProjection[2][3] + viewProjection[3][3];
+		if (w > 0)
+		{
+			buffer.occluderCandidates.push_back({ w, indices[i] });
+		}
+	}
+}
+
+
+void OcclusionRasterizeOccluders(OcclusionBuffer& buffer, const Float4x4* models, uint32_t maxOccluders)
+{
+	// The closest candidates, every cube has the same size so they cover the most texels
+	vector<pair<float, uint32_t>>& candidates = buffer.occluderCandidates;
+	const size_t count = min((size_t)maxOccluders, candidates.size());
+	if (count < candidates.size())
+	{
+		nth_element(candidates.begin(), candidates.begin() + count, candidates.end());
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (OcclusionRasterizeCube(buffer, models[candidates[i].second]))
+		{
+			buffer.occluderCount++;
+		}
+	}
+
+	OcclusionBuildPyramid(buffer);
+}
+
+
+////////////////////////////////////////////////
+// Occlusion tests
+////////////////////////////////////////////////
+
+// True if every texel of the range at the level is occluded for the depth, descending into the child texels
+// only where the depth is between the nearest and farthest occluder of a texel. rect is the cube's level 0 range.
+bool OcclusionRegionOccluded(const OcclusionBuffer& buffer, int32_t level, int32_t minX, int32_t minY, int32_t maxX, int32_t maxY, const int32_t rect[4], float nearestDepth)
+{
+	const int32_t width = occlusionWidth >> level;
+	const float* maxDepth = buffer.maxDepth[level].data();
+	const float* minDepth = buffer.minDepth[level].data();
+
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		for (int32_t x = minX; x <= maxX; x++)
+		{
+			const size_t texel = (size_t)y * width + x;
+			if (nearestDepth > maxDepth[texel])
+			{
+				continue;
+			}
+
+			// In front of some occluder texel, or in front of all of them at once
+			if (level == 0 || nearestDepth <= minDepth[texel])
+			{
+				return false;
+			}
+
+			const int32_t child = level - 1;
+			if (!OcclusionRegionOccluded(buffer, child,
+				max(x * 2, rect[0] >> child), max(y * 2, rect[1] >> child),
+				min(x * 2 + 1, rect[2] >> child), min(y * 2 + 1, rect[3] >> child), rect, nearestDepth))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+bool OcclusionCubeVisible(const OcclusionBuffer& buffer, const Float4x4& model)
+{
+	OcclusionVertex corners[8];
+	if (!OcclusionProjectCube(buffer.viewProjection, model, corners))
+	{
+		return true;
+	}
+
+
+	// Screen rectangle and nearest depth of the box, the cube is somewhere inside of it and never closer
+	float left = corners[0].x, top = corners[0].y, right = corners[0].x, bottom = corners[0].y, nearestDepth = corners[0].z;
+	for (int i = 1; i < 8; i++)
+	{
+		left = min(left, corners[i].x);
+		top = min(top, corners[i].y);
+		right = max(right, corners[i].x);
+		bottom = max(bottom, corners[i].y);
+		nearestDepth = min(nearestDepth, corners[i].z);
+	}
+
+	const int32_t rect[4] = {
+		(int32_t)clamp(left, 0.0f, (float)occlusionWidth),
+		(int32_t)clamp(top, 0.0f, (float)occlusionHeight),
+		(int32_t)ceilf(clamp(right, 0.0f, (float)occlusionWidth)) - 1,
+		(int32_t)ceilf(clamp(bottom, 0.0f, (float)occlusionHeight)) - 1,
+	};
+	if (rect[0] > rect[2] || rect[1] > rect[3])
+	{
+		return true;
+	}
+
+
+	// Start at the finest level where the rectangle touches at most 2x2 texels
+	int32_t level = 0;
+	while (level + 1 < occlusionLevelCount && ((rect[2] >> level) - (rect[0] >> level) > 1 || (rect[3] >> level) - (rect[1] >> level) > 1))
+	{
+		level++;
+	}
+
+	return !OcclusionRegionOccluded(buffer, level, rect[0] >> level, rect[1] >> level, rect[2] >> level, rect[3] >> level, rect, nearestDepth);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Core/VectorMath.h"
+
+// CPU occlusion culling that works the same with every render backend. The cubes closest to the viewer are
+// rasterized as occluders into a small depth buffer with 4 wide SIMD edge functions, then a min/max depth pyramid
+// is built from it and cubes are tested against the pyramid with the screen rectangle and nearest depth of their
+// corners. Occluders only write texels they cover completely, with the farthest depth they have inside of the
+// texel, so a cube is only reported hidden when it is behind an occluder at every pixel it could touch and culling
+// never changes the rendered image.
+//
+// Cubes are the [-1, 1] box of the cube mesh transformed by their model matrix.
+
+constexpr int32_t occlusionWidth = 256;
+constexpr int32_t occlusionHeight = 128;
+constexpr int32_t occlusionLevelCount = 6;   // 256x128 down to 8x4 texels
+constexpr uint32_t occlusionDefaultOccluderCount = 256;
+
+struct OcclusionBuffer {
+	Float4x4 viewProjection;
+
+	// Depth pyramid, level 0 is the rasterized buffer where the min and max depth of a texel are the same, so only
+	// maxDepth[0] is used. Texels without an occluder are at the far plane.
+	std::vector<float> minDepth[occlusionLevelCount];
+	std::vector<float> maxDepth[occlusionLevelCount];
+
+	std::vector<std::pair<float, uint32_t>> occluderCandidates; // Clip space w of the center and the cube index
+	uint32_t occluderCount = 0;                                   // Rasterized by the last OcclusionRasterizeOccluders
+};
+
+
+// Clear the buffer and its occluder candidates for a view
+void OcclusionBegin(OcclusionBuffer& buffer, const Float4x4& viewProjection);
+
+// Offer cubes as occluders, typically the ones that passed frustum culling
+void OcclusionAddOccluderCandidates(OcclusionBuffer& buffer, const Float4x4* models, const uint32_t* indices, size_t count);
+
+// Rasterize up to maxOccluders of the candidates, the closest ones first as they cover the most, and build the pyramid
+void OcclusionRasterizeOccluders(OcclusionBuffer& buffer, const Float4x4* models, uint32_t maxOccluders);
+
+// False if the cube is hidden behind the occluders. Cubes crossing the near plane or off screen count as visible.
+bool OcclusionCubeVisible(const OcclusionBuffer& buffer, const Float4x4& model);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <vector>
+
+#include "Core/VectorMath.h"
+#include "Core/Projection.h"
+
+static_assert(sizeof(Fov) == sizeof(XrFovf), "view fovs are handed to the projection as Fov");
+
+// Graphics API specific part of the app. Main.cpp drives OpenXR and the frame loop, a render backend owns the
+// graphics device, the GPU resources of the cube scene and the render targets for the runtime's swapchain images.
+struct RenderBackend {
+	virtual ~RenderBackend() = default;
+
+	// OpenXR extension binding this graphics API to a session
+	virtual const char* GetRenderingExtension() = 0;
+
+	// Query the runtime's graphics requirements and create a matching device
+	virtual bool CreateDevice(XrInstance instance, XrSystemId systemId) = 0;
+
+	// Graphics binding structure to chain into XrSessionCreateInfo, valid after CreateDevice
+	virtual const void* GetGraphicsBinding() = 0;
+
+	// Color formats the backend can render to, in the graphics API's own enumeration. Main picks the one the runtime
+	// prefers most, and the first one when the runtime's list can not be read
+	virtual const std::vector<int64_t>& GetSwapchainFormats() = 0;
+
+	// Depth formats for the depth swapchains submitted with XR_KHR_composition_layer_depth, the first one is also used
+	// for the backend's own depth buffers when the runtime supports none of them
+	virtual const std::vector<int64_t>& GetDepthSwapchainFormats() = 0;
+
+	// Set up the render state that depends on the picked swapchain formats, needs InitializeResources to have finished.
+	// Called for every session, a recreated session may pick different formats
+	virtual bool SetSwapchainFormats(int64_t colorFormat, int64_t depthFormat) = 0;
+
+	// Name of a format for log messages
+	virtual const char* GetFormatName(int64_t format) = 0;
+
+	// Shader preparation that does not need a device, so it can run in parallel with device and session creation
+	virtual bool CompileShaders() = 0;
+
+	// Create shaders, pipeline state and mesh buffers, needs CreateDevice and CompileShaders to have finished
+	virtual bool InitializeResources() = 0;
+
+	// Create render targets for every image of the color swapchain of a view. Depth is rendered into the images of
+	// depthSwapchain, or into depth buffers of the backend's own when it is XR_NULL_HANDLE
+	virtual bool CreateSwapchainImages(uint32_t viewIndex, XrSwapchain swapchain, XrSwapchain depthSwapchain, int32_t width, int32_t height) = 0;
+	virtual void DestroySwapchainImages(uint32_t viewIndex) = 0;
+
+	// Projection matrix for the graphics API's clip space conventions
+	virtual Float4x4 GetProjectionMatrix(const XrFovf& fov, float clipNear, float clipFar) = 0;
+
+	// Clear the acquired swapchain images of a view and draw one cube for every model matrix. depthImageIndex is the
+	// acquired depth swapchain image, or imageIndex again when the backend owns the depth buffers
+	virtual void RenderView(uint32_t viewIndex, uint32_t imageIndex, uint32_t depthImageIndex, const XrRect2Di& imageRect, const Float4x4& viewProjection, const std::vector<Float4x4>& models) = 0;
+
+	virtual void Shutdown() = 0;
+};
+
+
+RenderBackend* CreateD3D11RenderBackend();
+RenderBackend* CreateVulkanRenderBackend();
@@ -0,0 +1,542 @@
+#pragma comment(lib,"D3D11.lib")
+#pragma comment(lib,"D3dcompiler.lib")
+#pragma comment(lib,"Dxgi.lib")
+
+// Tell OpenXR which platform code we'll be using
+#define XR_USE_PLATFORM_WIN32
+#define XR_USE_GRAPHICS_API_D3D11
+
+#include <d3d11.h>
+#include <d3dcompiler.h>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include <vector>
+
+#include "RenderBackend.h"
+#include "CubeMesh.h"
+
+using namespace std;
+
+
+struct D3DSwapchainImages {
+	vector<XrSwapchainImageD3D11KHR> xrSwapchainImages;
+	vector<XrSwapchainImageD3D11KHR> xrDepthSwapchainImages; // Empty when the depth buffers are our own
+	vector<ID3D11DepthStencilView*> depthStencilViews;       // One per depth swapchain image, or per color image
+	vector<ID3D11RenderTargetView*> renderTargetViews;
+};
+
+
+// CPU data
+struct ModelConstantBuffer {
+	Float4x4 Model;
+};
+
+struct ViewProjectionConstantBuffer {
+	Float4x4 ViewProjection;
+};
+
+// Swapchain formats we can render to. sRGB formats first, the hardware encodes on write so blending and filtering in
+// the compositor happen on linear values
+const vector<int64_t> d3dColorFormats = { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM };
+const vector<int64_t> d3dDepthFormats = { DXGI_FORMAT_D32_FLOAT, DXGI_FORMAT_D24_UNORM_S8_UINT, DXGI_FORMAT_D16_UNORM, DXGI_FORMAT_D32_FLOAT_S8X24_UINT };
+
+// GPU settings and resources
+PFN_xrGetD3D11GraphicsRequirementsKHR ext_xrGetD3D11GraphicsRequirementsKHR = nullptr;
+XrGraphicsRequirementsD3D11KHR xrGraphicsRequirements = { XR_TYPE_GRAPHICS_REQUIREMENTS_D3D11_KHR };
+XrGraphicsBindingD3D11KHR xrGraphicsBinding = { XR_TYPE_GRAPHICS_BINDING_D3D11_KHR };
+
+IDXGIAdapter1* graphicsAdapter = nullptr;
+IDXGIFactory1* dxgiFactory;
+DXGI_ADAPTER_DESC1 adapterDesc;
+
+D3D_FEATURE_LEVEL featureLevels[] = { D3D_FEATURE_LEVEL_11_0 };
+
+ID3D11Device* d3dDevice = nullptr;
+ID3D11DeviceContext* d3dContext = nullptr;
+
+ID3DBlob* vertexShaderBytes = nullptr;
+ID3DBlob* pixelShaderBytes = nullptr;
+ID3DBlob* srgbPixelShaderBytes = nullptr;
+ID3D11VertexShader* vertexShader;
+ID3D11PixelShader* pixelShader;
+ID3D11PixelShader* srgbPixelShader; // For sRGB render targets
+ID3D11InputLayout* inputLayout;
+ID3D11Buffer* modelConstantBuffer;
+ID3D11Buffer* viewProjectionConstantBuffer;
+ID3D11Buffer* vertexBuffer;
+ID3D11Buffer* indexBuffer;
+
+DXGI_FORMAT d3dColorFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+DXGI_FORMAT d3dDepthFormat = DXGI_FORMAT_D32_FLOAT;
+ID3D11PixelShader* d3dActivePixelShader = nullptr; // Matching d3dColorFormat
+
+vector<D3DSwapchainImages> d3dSwapchainImages;
+
+
+constexpr char shader[] = R"_(
+
+cbuffer ModelConstantBuffer : register(b0)
+{
+	float4x4 Model;
+};
+
+cbuffer ViewProjectionConstantBuffer : register(b1)
+{
+	float4x4 ViewProjection;
+};
+
+struct VertexShaderInput
+{
+	float4 pos   : SV_POSITION;
+	float3 color : COLOR0;
+};
+
+struct VertexShaderOutput
+{
+	float4 pos   : SV_POSITION;
+	float3 color : COLOR0;
+};
+
+VertexShaderOutput vs(VertexShaderInput input)
+{
+	VertexShaderOutput output;
+
+	output.pos = mul(float4(input.pos.xyz, 1), Model);
+	output.pos = mul(output.pos, ViewProjection);
+
+	output.color = input.color;
+	return output;
+}
+
+float4 ps(VertexShaderOutput input) : SV_TARGET
+{
+	return float4(input.color, 1);
+}
+
+// Vertex colors are sRGB values, an sRGB render target encodes on write so they have to be linear first
+float4 psSrgb(VertexShaderOutput input) : SV_TARGET
+{
+	float3 color = input.color <= 0.04045 ? input.color / 12.92 : pow((input.color + 0.055) / 1.055, 2.4);
+	return float4(color, 1);
+})_";
+
+
+////////////////////////////////////////////////
+// Graphics - Direct3D
+////////////////////////////////////////////////
+
+void D3DShutdown()
+{
+	if (d3dContext)
+	{
+		d3dContext->Release();
+		d3dContext = nullptr;
+	}
+	if (d3dDevice)
+	{
+		d3dDevice->Release();
+		d3dDevice = nullptr;
+	}
+}
+
+
+void D3DDestroySwapchain(D3DSwapchainImages& swapchain)
+{
+	for (ID3D11RenderTargetView* renderTargetView : swapchain.renderTargetViews)
+	{
+		renderTargetView->Release();
+	}
+	for (ID3D11DepthStencilView* depthStencilView : swapchain.depthStencilViews)
+	{
+		depthStencilView->Release();
+	}
+
+	swapchain = {};
+}
+
+
+ID3DBlob* D3DCompileShader(const char* hlsl, const char* entrypoint, const char* target) {
+	DWORD flags = D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
+#ifdef _DEBUG
+	flags |= D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_DEBUG;
+#else
+	flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+	// errors is only set when the compiler got as far as the HLSL, a failed compile returns nullptr even if it set compiled
+	ID3DBlob* compiled = nullptr;
+	ID3DBlob* errors = nullptr;
+	const HRESULT result = D3DCompile(hlsl, strlen(hlsl), nullptr, nullptr, nullptr, entrypoint, target, flags, 0, &compiled, &errors);
+	if (FAILED(result))
+	{
+		printf("Error: D3DCompile of %s failed 0x%08X %s\n", entrypoint, (unsigned)result, errors != nullptr ? (const char*)errors->GetBufferPointer() : "");
+		if (compiled != nullptr)
+		{
+			compiled->Release();
+			compiled = nullptr;
+		}
+	}
+	if (errors != nullptr)
+	{
+		errors->Release();
+	}
+
+	return compiled;
+}
+
+
+bool D3DCompileShaders()
+{
+	// Shader compilation needs no device, so it can run while the OpenXR session is still being created
+	vertexShaderBytes = D3DCompileShader(shader, "vs", "vs_5_0");
+	pixelShaderBytes = D3DCompileShader(shader, "ps", "ps_5_0");
+	srgbPixelShaderBytes = D3DCompileShader(shader, "psSrgb", "ps_5_0");
+
+	if (vertexShaderBytes != nullptr && pixelShaderBytes != nullptr && srgbPixelShaderBytes != nullptr)
+	{
+		return true;
+	}
+
+	// Release the shaders that did compile, InitializeResources never runs to release them
+	for (ID3DBlob** bytes : { &vertexShaderBytes, &pixelShaderBytes, &srgbPixelShaderBytes })
+	{
+		if (*bytes != nullptr)
+		{
+			(*bytes)->Release();
+			*bytes = nullptr;
+		}
+	}
+	return false;
+}
+
+
+bool D3DCreateDevice(XrInstance xrInstance, XrSystemId xrSystemId)
+{
+	// Get D3D11 Graphics requirements for the app
+	{
+		xrGetInstanceProcAddr(xrInstance, "xrGetD3D11GraphicsRequirementsKHR", (PFN_xrVoidFunction*)(&ext_xrGetD3D11GraphicsRequirementsKHR));
+		ext_xrGetD3D11GraphicsRequirementsKHR(xrInstance, xrSystemId, &xrGraphicsRequirements);
+	}
+
+
+	// Create DXGI Factory
+	{
+		CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)(&dxgiFactory));
+	}
+
+
+	// Use DXGI Factory to try finding graphics card with matching luid from graphics requirements
+	{
+		int adapterIndex = 0;
+		bool foundAdapter = false;
+		while (dxgiFactory->EnumAdapters1(adapterIndex++, &graphicsAdapter) == S_OK)
+		{
+			graphicsAdapter->GetDesc1(&adapterDesc);
+
+			if (memcmp(&adapterDesc.AdapterLuid, &xrGraphicsRequirements.adapterLuid, sizeof(&xrGraphicsRequirements.adapterLuid)) == 0) {
+				foundAdapter = true;
+				break;
+			}
+
+		}
+		dxgiFactory->Release();
+
+		if (!foundAdapter)
+		{
+			return false;
+		}
+	}
+
+
+	// Create D3D11 device for required feature levels. The device is free threaded, so resources can be created from several startup tasks at once
+	{
+		if (FAILED(D3D11CreateDevice(graphicsAdapter, D3D_DRIVER_TYPE_UNKNOWN, 0, 0, featureLevels, _countof(featureLevels), D3D11_SDK_VERSION, &d3dDevice, nullptr, &d3dContext)))
+		{
+			return false;
+		}
+
+		graphicsAdapter->Release();
+	}
+
+
+	// Graphics binding the session will be created with
+	{
+		xrGraphicsBinding.device = d3dDevice;
+	}
+
+	return true;
+}
+
+
+bool D3DInitializeResources()
+{
+	// Turn our compiled shader code into shader resources!
+	d3dDevice->CreateVertexShader(vertexShaderBytes->GetBufferPointer(), vertexShaderBytes->GetBufferSize(), nullptr, &vertexShader);
+	d3dDevice->CreatePixelShader(pixelShaderBytes->GetBufferPointer(), pixelShaderBytes->GetBufferSize(), nullptr, &pixelShader);
+	d3dDevice->CreatePixelShader(srgbPixelShaderBytes->GetBufferPointer(), srgbPixelShaderBytes->GetBufferSize(), nullptr, &srgbPixelShader);
+
+
+	// CREATE INPUT LAYOUT
+	// Describe how our mesh is laid out in memory
+	D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
+	{
+		{"SV_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+	};
+
+	d3dDevice->CreateInputLayout(vertexDesc, (UINT)_countof(vertexDesc), vertexShaderBytes->GetBufferPointer(), vertexShaderBytes->GetBufferSize(), &inputLayout);
+
+
+	// CREATE GPU RESOURCES FROM VERTEX BUFFER, INDICES BUFFER, CONSTANT BUFFERS (NO DATA YET) // declared buffers on GPU, create by GPU and pass reference back
+	// its same as buffer b = new buffer, but gpu does creation and memory management?
+	// Create GPU resources for our mesh's vertices and indices! Constant buffers are for passing transform
+	// matrices into the shaders, so make a buffer for them too!
+	D3D11_SUBRESOURCE_DATA vertexBufferData = { cubeVertices };
+	D3D11_SUBRESOURCE_DATA indexBufferData = { cubeIndices };
+
+	CD3D11_BUFFER_DESC vertexBufferDesc(sizeof(cubeVertices), D3D11_BIND_VERTEX_BUFFER);
+	CD3D11_BUFFER_DESC indexBufferDesc(sizeof(cubeIndices), D3D11_BIND_INDEX_BUFFER);
+
+	CD3D11_BUFFER_DESC modelConstantBufferDesc(sizeof(ModelConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+	CD3D11_BUFFER_DESC viewProjectionConstantBufferDesc(sizeof(ViewProjectionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+	d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &vertexBuffer);
+	d3dDevice->CreateBuffer(&indexBufferDesc, &indexBufferData, &indexBuffer);
+	d3dDevice->CreateBuffer(&modelConstantBufferDesc, nullptr, &modelConstantBuffer); // no data yet, constant buffer will  be updated every frame
+	d3dDevice->CreateBuffer(&viewProjectionConstantBufferDesc, nullptr, &viewProjectionConstantBuffer);
+
+
+	// Compiled bytecode is no longer needed once the shaders and input layout exist
+	vertexShaderBytes->Release();
+	pixelShaderBytes->Release();
+	srgbPixelShaderBytes->Release();
+	vertexShaderBytes = nullptr;
+	pixelShaderBytes = nullptr;
+	srgbPixelShaderBytes = nullptr;
+
+	return true;
+}
+
+
+bool D3DSetSwapchainFormats(int64_t colorFormat, int64_t depthFormat)
+{
+	// Views are created with these formats, the runtime may hand out typeless textures. Our own depth buffers stay D32
+	// as the runtime never sees them
+	d3dColorFormat = (DXGI_FORMAT)colorFormat;
+	d3dDepthFormat = (DXGI_FORMAT)depthFormat;
+
+	const bool srgb = d3dColorFormat == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB || d3dColorFormat == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+	d3dActivePixelShader = srgb ? srgbPixelShader : pixelShader;
+	return true;
+}
+
+
+const char* D3DFormatName(int64_t format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: return "DXGI_FORMAT_R8G8B8A8_UNORM_SRGB";
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: return "DXGI_FORMAT_B8G8R8A8_UNORM_SRGB";
+	case DXGI_FORMAT_R8G8B8A8_UNORM: return "DXGI_FORMAT_R8G8B8A8_UNORM";
+	case DXGI_FORMAT_B8G8R8A8_UNORM: return "DXGI_FORMAT_B8G8R8A8_UNORM";
+	case DXGI_FORMAT_D32_FLOAT: return "DXGI_FORMAT_D32_FLOAT";
+	case DXGI_FORMAT_D24_UNORM_S8_UINT: return "DXGI_FORMAT_D24_UNORM_S8_UINT";
+	case DXGI_FORMAT_D16_UNORM: return "DXGI_FORMAT_D16_UNORM";
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT: return "DXGI_FORMAT_D32_FLOAT_S8X24_UINT";
+	default: return "unknown DXGI format";
+	}
+}
+
+
+bool D3DCreateSwapchainImages(uint32_t viewIndex, XrSwapchain xrSwapchain, XrSwapchain xrDepthSwapchain)
+{
+	uint32_t swapchainLength = 0;
+	uint32_t depthSwapchainLength = 0;
+
+	if (d3dSwapchainImages.size() <= viewIndex)
+	{
+		d3dSwapchainImages.resize(viewIndex + 1);
+	}
+
+	D3DSwapchainImages& swapchainImages = d3dSwapchainImages[viewIndex];
+
+
+	// Find out how many textures were generated for the swapchains by device runtime
+	{
+		xrEnumerateSwapchainImages(xrSwapchain, 0, &swapchainLength, nullptr);
+		if (xrDepthSwapchain != XR_NULL_HANDLE)
+		{
+			xrEnumerateSwapchainImages(xrDepthSwapchain, 0, &depthSwapchainLength, nullptr);
+		}
+	}
+
+
+	// Cache swapchain images created by runtime device, so we can draw onto them later
+	{
+		swapchainImages.xrSwapchainImages.resize(swapchainLength, { XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR });
+		swapchainImages.renderTargetViews.resize(swapchainLength);
+		xrEnumerateSwapchainImages(xrSwapchain, swapchainLength, &swapchainLength, (XrSwapchainImageBaseHeader*)swapchainImages.xrSwapchainImages.data());
+
+		if (xrDepthSwapchain != XR_NULL_HANDLE)
+		{
+			swapchainImages.xrDepthSwapchainImages.resize(depthSwapchainLength, { XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR });
+			xrEnumerateSwapchainImages(xrDepthSwapchain, depthSwapchainLength, &depthSwapchainLength, (XrSwapchainImageBaseHeader*)swapchainImages.xrDepthSwapchainImages.data());
+		}
+		swapchainImages.depthStencilViews.resize(xrDepthSwapchain != XR_NULL_HANDLE ? depthSwapchainLength : swapchainLength);
+	}
+
+
+	// Create render target view and depth stencial view for every swapchain image
+	for (uint32_t i = 0; i < swapchainLength; i++)
+	{
+		D3D11_TEXTURE2D_DESC colorTextureDesc;
+		ID3D11Texture2D* depthTexture;
+
+
+		// Create render target view resource for swapchain image
+		{
+			swapchainImages.xrSwapchainImages[i].texture->GetDesc(&colorTextureDesc);
+
+			D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc = {};
+			renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+			renderTargetViewDesc.Format = d3dColorFormat;
+			d3dDevice->CreateRenderTargetView(swapchainImages.xrSwapchainImages[i].texture, &renderTargetViewDesc, &swapchainImages.renderTargetViews[i]);
+		}
+
+
+		// Depth goes to the runtime's depth swapchain images instead, they get their views below
+		if (xrDepthSwapchain != XR_NULL_HANDLE)
+		{
+			continue;
+		}
+
+
+		// Create texture for depth stencil
+		{
+			D3D11_TEXTURE2D_DESC depthTextureDesc = {};
+			depthTextureDesc.SampleDesc.Count = 1;
+			depthTextureDesc.MipLevels = 1;
+			depthTextureDesc.Width = colorTextureDesc.Width;
+			depthTextureDesc.Height = colorTextureDesc.Height;
+			depthTextureDesc.ArraySize = colorTextureDesc.ArraySize;
+			depthTextureDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+			depthTextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_DEPTH_STENCIL;
+
+			d3dDevice->CreateTexture2D(&depthTextureDesc, nullptr, &depthTexture);
+		}
+
+
+		// Create depth stencil view resource for swapchain image
+		{
+			D3D11_DEPTH_STENCIL_VIEW_DESC dephViewDesc = {};
+			dephViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+			dephViewDesc.Format = DXGI_FORMAT_D32_FLOAT;
+			d3dDevice->CreateDepthStencilView(depthTexture, &dephViewDesc, &swapchainImages.depthStencilViews[i]);
+		}
+
+
+		// We don't need direct access to the ID3D11Texture2D object anymore, we only need the view
+		depthTexture->Release();
+	}
+
+
+	// Create depth stencil view for every depth swapchain image, the runtime reads the depth back when it composes the layer
+	for (uint32_t i = 0; i < depthSwapchainLength; i++)
+	{
+		D3D11_DEPTH_STENCIL_VIEW_DESC dephViewDesc = {};
+		dephViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+		dephViewDesc.Format = d3dDepthFormat;
+		d3dDevice->CreateDepthStencilView(swapchainImages.xrDepthSwapchainImages[i].texture, &dephViewDesc, &swapchainImages.depthStencilViews[i]);
+	}
+
+	return true;
+}
+
+
+void D3DRenderView(uint32_t viewIndex, uint32_t imageId, uint32_t depthImageId, const XrRect2Di& rect, const Float4x4& viewProjection, const vector<Float4x4>& models)
+{
+	D3DSwapchainImages& swapchainImages = d3dSwapchainImages[viewIndex];
+
+
+	// Set D3D viewport we will render onto with same swapchain image dimension
+	{
+		D3D11_VIEWPORT viewport = CD3D11_VIEWPORT((float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height);
+		d3dContext->RSSetViewports(1, &viewport);
+	}
+
+
+	// Clear swapchain color and depth views, and set them up for rendering on d3D rendering pipeline
+	{
+		float clear[] = { 0, 0, 0, 1 };
+		d3dContext->ClearRenderTargetView(swapchainImages.renderTargetViews[imageId], clear);
+		d3dContext->ClearDepthStencilView(swapchainImages.depthStencilViews[depthImageId], D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+		d3dContext->OMSetRenderTargets(1, &swapchainImages.renderTargetViews[imageId], swapchainImages.depthStencilViews[depthImageId]);
+	}
+
+
+	// Set the active shaders and constant buffers on Vector and Pixel Shader stages of D3D rendering pipeline
+	{
+		ID3D11Buffer* const constantBuffers[] = { modelConstantBuffer , viewProjectionConstantBuffer };
+		d3dContext->VSSetConstantBuffers(0, (UINT)std::size(constantBuffers), constantBuffers);
+		d3dContext->VSSetShader(vertexShader, nullptr, 0);
+		d3dContext->PSSetShader(d3dActivePixelShader, nullptr, 0);
+	}
+
+
+	//	Hook cube mesh triangles data, the vertex buffer and index buffer on Input Assembly stage of D3D rendering pipeline
+	{
+		UINT strides[] = { cubeVertexStride };
+		UINT offsets[] = { 0 };
+		d3dContext->IASetVertexBuffers(0, 1, &vertexBuffer, strides, offsets);
+		d3dContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+		d3dContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		d3dContext->IASetInputLayout(inputLayout);
+	}
+
+
+	// Update shader's view projection constant buffer, the shader expects column major matrices
+	{
+		ViewProjectionConstantBuffer viewproj;
+		viewproj.ViewProjection = MatrixTranspose(viewProjection);
+		d3dContext->UpdateSubresource(viewProjectionConstantBuffer, 0, nullptr, &viewproj, 0, 0);
+	}
+
+
+	// Update shader's model contant buffer with every cube's model matrix and draw cube triangles
+	{
+		ModelConstantBuffer model;
+
+		for (size_t i = 0; i < models.size(); i++)
+		{
+			model.Model = MatrixTranspose(models[i]);
+			d3dContext->UpdateSubresource(modelConstantBuffer, 0, nullptr, &model, 0, 0);
+			d3dContext->DrawIndexed(cubeIndexCount, 0, 0);
+		}
+	}
+}
+
+
+struct D3D11RenderBackend : RenderBackend {
+	const char* GetRenderingExtension() override { return XR_KHR_D3D11_ENABLE_EXTENSION_NAME; }
+	bool CreateDevice(XrInstance instance, XrSystemId systemId) override { return D3DCreateDevice(instance, systemId); }
+	const void* GetGraphicsBinding() override { return &xrGraphicsBinding; }
+	const vector<int64_t>& GetSwapchainFormats() override { return d3dColorFormats; }
+	const vector<int64_t>& GetDepthSwapchainFormats() override { return d3dDepthFormats; }
+	bool SetSwapchainFormats(int64_t colorFormat, int64_t depthFormat) override { return D3DSetSwapchainFormats(colorFormat, depthFormat); }
+	const char* GetFormatName(int64_t format) override { return D3DFormatName(format); }
+	bool CompileShaders() override { return D3DCompileShaders(); }
+	bool InitializeResources() override { return D3DInitializeResources(); }
+	bool CreateSwapchainImages(uint32_t viewIndex, XrSwapchain swapchain, XrSwapchain depthSwapchain, int32_t, int32_t) override { return D3DCreateSwapchainImages(viewIndex, swapchain, depthSwapchain); }
+	void DestroySwapchainImages(uint32_t viewIndex) override { D3DDestroySwapchain(d3dSwapchainImages[viewIndex]); }
+	Float4x4 GetProjectionMatrix(const XrFovf& fov, float clipNear, float clipFar) override { return ProjectionFromFov(*(const Fov*)&fov, clipNear, clipFar); }
+	void RenderView(uint32_t viewIndex, uint32_t imageIndex, uint32_t depthImageIndex, const XrRect2Di& imageRect, const Float4x4& viewProjection, const vector<Float4x4>& models) override { D3DRenderView(viewIndex, imageIndex, depthImageIndex, imageRect, viewProjection, models); }
+	void Shutdown() override { D3DShutdown(); }
+};
+
+
+RenderBackend* CreateD3D11RenderBackend()
+{
+	return new D3D11RenderBackend();
+}
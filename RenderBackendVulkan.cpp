@@ -0,0 +1,835 @@
+// Tell OpenXR which platform code we'll be using
+#define XR_USE_GRAPHICS_API_VULKAN
+
+#include <vulkan/vulkan.h>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "RenderBackend.h"
+#include "CubeMesh.h"
+
+// SPIR-V of Shaders/Cube.vert and Shaders/Cube.frag, generated by the build
+#include "Cube.vert.spv.h"
+#include "Cube.frag.spv.h"
+
+using namespace std;
+
+
+struct VulkanSwapchainImages {
+	vector<XrSwapchainImageVulkan2KHR> xrSwapchainImages;
+	vector<XrSwapchainImageVulkan2KHR> xrDepthSwapchainImages; // Empty when the depth buffers are our own
+	vector<VkImageView> colorViews;
+	vector<VkImage> depthImages;                               // Our own depth buffers, one per color image
+	vector<VkDeviceMemory> depthMemories;
+	vector<VkImageView> depthViews;                            // One per depth swapchain image, or per color image
+	vector<VkFramebuffer> framebuffers;                        // One per color and depth image pair, see VulkanFramebufferIndex
+
+	// Every view records into its own command buffer, the fence tells when the previous frame's commands are done
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;
+};
+
+
+// Push constants, matrices are row vector matrices which read as column major GLSL matrices are already transposed
+struct VulkanPushConstants {
+	Float4x4 Model;
+	Float4x4 ViewProjection;
+};
+
+// Swapchain formats we can render to, in the same order as the Direct3D 11 backend
+const vector<int64_t> vulkanColorFormats = { VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_B8G8R8A8_UNORM };
+const vector<int64_t> vulkanDepthFormats = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM, VK_FORMAT_D32_SFLOAT_S8_UINT };
+
+// GPU settings and resources
+VkFormat vulkanColorFormat = VK_FORMAT_UNDEFINED; // Picked for the swapchains, render passes and pipeline are created for them
+VkFormat vulkanDepthFormat = VK_FORMAT_UNDEFINED;
+
+XrGraphicsRequirementsVulkan2KHR xrVulkanGraphicsRequirements = { XR_TYPE_GRAPHICS_REQUIREMENTS_VULKAN2_KHR };
+XrGraphicsBindingVulkan2KHR xrVulkanGraphicsBinding = { XR_TYPE_GRAPHICS_BINDING_VULKAN2_KHR };
+
+VkInstance vulkanInstance = VK_NULL_HANDLE;
+VkPhysicalDevice vulkanPhysicalDevice = VK_NULL_HANDLE;
+VkDevice vulkanDevice = VK_NULL_HANDLE;
+uint32_t vulkanQueueFamilyIndex = 0;
+VkQueue vulkanQueue = VK_NULL_HANDLE;
+VkCommandPool vulkanCommandPool = VK_NULL_HANDLE;
+VkRenderPass vulkanRenderPass = VK_NULL_HANDLE;
+VkRenderPass vulkanRenderPassStoreDepth = VK_NULL_HANDLE; // Compatible with vulkanRenderPass, keeps depth for the runtime
+
+VkShaderModule vulkanVertexShaderModule = VK_NULL_HANDLE;
+VkShaderModule vulkanFragmentShaderModule = VK_NULL_HANDLE;
+VkPipelineLayout vulkanPipelineLayout = VK_NULL_HANDLE;
+VkPipeline vulkanPipeline = VK_NULL_HANDLE;
+VkBuffer vulkanVertexBuffer = VK_NULL_HANDLE;
+VkDeviceMemory vulkanVertexBufferMemory = VK_NULL_HANDLE;
+VkBuffer vulkanIndexBuffer = VK_NULL_HANDLE;
+VkDeviceMemory vulkanIndexBufferMemory = VK_NULL_HANDLE;
+
+vector<VulkanSwapchainImages> vulkanSwapchainImages;
+
+
+////////////////////////////////////////////////
+// Graphics - Vulkan
+////////////////////////////////////////////////
+
+bool VulkanFindMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties, uint32_t& memoryTypeIndex)
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(vulkanPhysicalDevice, &memoryProperties);
+
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+	{
+		if ((memoryTypeBits & (1u << i)) != 0 && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+		{
+			memoryTypeIndex = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool VulkanCreateBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& memory)
+{
+	// Create buffer object
+	{
+		VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateBuffer(vulkanDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+		{
+			return false;
+		}
+	}
+
+
+	// Back it with host visible memory, the mesh is tiny and written once so there is no need for a staging copy
+	{
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(vulkanDevice, buffer, &memoryRequirements);
+
+		VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		allocateInfo.allocationSize = memoryRequirements.size;
+		if (!VulkanFindMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, allocateInfo.memoryTypeIndex) ||
+			vkAllocateMemory(vulkanDevice, &allocateInfo, nullptr, &memory) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		vkBindBufferMemory(vulkanDevice, buffer, memory, 0);
+	}
+
+
+	// Upload data
+	{
+		void* mapped;
+		vkMapMemory(vulkanDevice, memory, 0, size, 0, &mapped);
+		memcpy(mapped, data, (size_t)size);
+		vkUnmapMemory(vulkanDevice, memory);
+	}
+
+	return true;
+}
+
+
+VkShaderModule VulkanCreateShaderModule(const uint32_t* code, size_t size)
+{
+	VkShaderModuleCreateInfo shaderModuleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	shaderModuleInfo.codeSize = size;
+	shaderModuleInfo.pCode = code;
+
+	VkShaderModule shaderModule = VK_NULL_HANDLE;
+	vkCreateShaderModule(vulkanDevice, &shaderModuleInfo, nullptr, &shaderModule);
+	return shaderModule;
+}
+
+
+bool VulkanCreateDevice(XrInstance xrInstance, XrSystemId xrSystemId)
+{
+	PFN_xrGetVulkanGraphicsRequirements2KHR ext_xrGetVulkanGraphicsRequirements2KHR = nullptr;
+	PFN_xrCreateVulkanInstanceKHR ext_xrCreateVulkanInstanceKHR = nullptr;
+	PFN_xrGetVulkanGraphicsDevice2KHR ext_xrGetVulkanGraphicsDevice2KHR = nullptr;
+	PFN_xrCreateVulkanDeviceKHR ext_xrCreateVulkanDeviceKHR = nullptr;
+
+
+	// Get pointers to the Vulkan enable functions from extension
+	{
+		const bool found =
+			XR_SUCCEEDED(xrGetInstanceProcAddr(xrInstance, "xrGetVulkanGraphicsRequirements2KHR", (PFN_xrVoidFunction*)(&ext_xrGetVulkanGraphicsRequirements2KHR))) &&
+			XR_SUCCEEDED(xrGetInstanceProcAddr(xrInstance, "xrCreateVulkanInstanceKHR", (PFN_xrVoidFunction*)(&ext_xrCreateVulkanInstanceKHR))) &&
+			XR_SUCCEEDED(xrGetInstanceProcAddr(xrInstance, "xrGetVulkanGraphicsDevice2KHR", (PFN_xrVoidFunction*)(&ext_xrGetVulkanGraphicsDevice2KHR))) &&
+			XR_SUCCEEDED(xrGetInstanceProcAddr(xrInstance, "xrCreateVulkanDeviceKHR", (PFN_xrVoidFunction*)(&ext_xrCreateVulkanDeviceKHR)));
+		if (!found || ext_xrGetVulkanGraphicsRequirements2KHR == nullptr || ext_xrCreateVulkanInstanceKHR == nullptr ||
+			ext_xrGetVulkanGraphicsDevice2KHR == nullptr || ext_xrCreateVulkanDeviceKHR == nullptr)
+		{
+			printf("Error: the runtime does not provide the XR_KHR_vulkan_enable2 functions\n");
+			return false;
+		}
+	}
+
+
+	// Get Vulkan Graphics requirements for the app
+	{
+		if (XR_FAILED(ext_xrGetVulkanGraphicsRequirements2KHR(xrInstance, xrSystemId, &xrVulkanGraphicsRequirements)))
+		{
+			printf("Error: xrGetVulkanGraphicsRequirements2KHR failed\n");
+			return false;
+		}
+	}
+
+
+	// Vulkan version to create the instance with, the 1.1 the renderer is written against or the lowest version the
+	// runtime supports when that is newer. Only major and minor versions are compared, the runtime's patch versions
+	// do not limit the API
+	uint32_t apiVersion = 0;
+	{
+		const XrVersion minVersion = xrVulkanGraphicsRequirements.minApiVersionSupported;
+		const XrVersion maxVersion = xrVulkanGraphicsRequirements.maxApiVersionSupported;
+		const XrVersion rendererVersion = XR_MAKE_VERSION(1, 1, 0);
+		const XrVersion lowestVersion = XR_MAKE_VERSION(XR_VERSION_MAJOR(minVersion), XR_VERSION_MINOR(minVersion), 0);
+		const XrVersion highestVersion = XR_MAKE_VERSION(XR_VERSION_MAJOR(maxVersion), XR_VERSION_MINOR(maxVersion), 0);
+
+		const XrVersion version = lowestVersion > rendererVersion ? lowestVersion : rendererVersion;
+		if (version > highestVersion)
+		{
+			printf("Error: the runtime supports Vulkan %u.%u to %u.%u, the renderer needs 1.1 or newer\n",
+				(uint32_t)XR_VERSION_MAJOR(minVersion), (uint32_t)XR_VERSION_MINOR(minVersion),
+				(uint32_t)XR_VERSION_MAJOR(maxVersion), (uint32_t)XR_VERSION_MINOR(maxVersion));
+			return false;
+		}
+
+		apiVersion = VK_MAKE_VERSION(XR_VERSION_MAJOR(version), XR_VERSION_MINOR(version), 0);
+	}
+
+
+	// Let the runtime create the Vulkan instance, so it can add the instance extensions it needs
+	{
+		VkApplicationInfo applicationInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+		applicationInfo.pApplicationName = "OpenXR Example";
+		applicationInfo.apiVersion = apiVersion;
+
+		VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+		instanceInfo.pApplicationInfo = &applicationInfo;
+
+		XrVulkanInstanceCreateInfoKHR xrInstanceInfo = { XR_TYPE_VULKAN_INSTANCE_CREATE_INFO_KHR };
+		xrInstanceInfo.systemId = xrSystemId;
+		xrInstanceInfo.pfnGetInstanceProcAddr = &vkGetInstanceProcAddr;
+		xrInstanceInfo.vulkanCreateInfo = &instanceInfo;
+
+		VkResult vulkanResult = VK_SUCCESS;
+		if (XR_FAILED(ext_xrCreateVulkanInstanceKHR(xrInstance, &xrInstanceInfo, &vulkanInstance, &vulkanResult)) || vulkanResult != VK_SUCCESS)
+		{
+			return false;
+		}
+	}
+
+
+	// Ask the runtime which physical device it is presenting with
+	{
+		XrVulkanGraphicsDeviceGetInfoKHR deviceGetInfo = { XR_TYPE_VULKAN_GRAPHICS_DEVICE_GET_INFO_KHR };
+		deviceGetInfo.systemId = xrSystemId;
+		deviceGetInfo.vulkanInstance = vulkanInstance;
+
+		if (XR_FAILED(ext_xrGetVulkanGraphicsDevice2KHR(xrInstance, &deviceGetInfo, &vulkanPhysicalDevice)))
+		{
+			return false;
+		}
+	}
+
+
+	// Find a queue family with graphics support
+	{
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, nullptr);
+		vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(vulkanPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		bool foundQueueFamily = false;
+		for (uint32_t i = 0; i < queueFamilyCount; i++)
+		{
+			if ((queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0)
+			{
+				vulkanQueueFamilyIndex = i;
+				foundQueueFamily = true;
+				break;
+			}
+		}
+
+		if (!foundQueueFamily)
+		{
+			return false;
+		}
+	}
+
+
+	// Let the runtime create the Vulkan device with one graphics queue
+	{
+		float queuePriority = 1.0f;
+		VkDeviceQueueCreateInfo queueInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+		queueInfo.queueFamilyIndex = vulkanQueueFamilyIndex;
+		queueInfo.queueCount = 1;
+		queueInfo.pQueuePriorities = &queuePriority;
+
+		VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+		deviceInfo.queueCreateInfoCount = 1;
+		deviceInfo.pQueueCreateInfos = &queueInfo;
+
+		XrVulkanDeviceCreateInfoKHR xrDeviceInfo = { XR_TYPE_VULKAN_DEVICE_CREATE_INFO_KHR };
+		xrDeviceInfo.systemId = xrSystemId;
+		xrDeviceInfo.pfnGetInstanceProcAddr = &vkGetInstanceProcAddr;
+		xrDeviceInfo.vulkanPhysicalDevice = vulkanPhysicalDevice;
+		xrDeviceInfo.vulkanCreateInfo = &deviceInfo;
+
+		VkResult vulkanResult = VK_SUCCESS;
+		if (XR_FAILED(ext_xrCreateVulkanDeviceKHR(xrInstance, &xrDeviceInfo, &vulkanDevice, &vulkanResult)) || vulkanResult != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		vkGetDeviceQueue(vulkanDevice, vulkanQueueFamilyIndex, 0, &vulkanQueue);
+	}
+
+
+	// Create command pool for the per view command buffers
+	{
+		VkCommandPoolCreateInfo commandPoolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		commandPoolInfo.queueFamilyIndex = vulkanQueueFamilyIndex;
+		vkCreateCommandPool(vulkanDevice, &commandPoolInfo, nullptr, &vulkanCommandPool);
+	}
+
+
+	// Graphics binding the session will be created with
+	{
+		xrVulkanGraphicsBinding.instance = vulkanInstance;
+		xrVulkanGraphicsBinding.physicalDevice = vulkanPhysicalDevice;
+		xrVulkanGraphicsBinding.device = vulkanDevice;
+		xrVulkanGraphicsBinding.queueFamilyIndex = vulkanQueueFamilyIndex;
+		xrVulkanGraphicsBinding.queueIndex = 0;
+	}
+
+	return true;
+}
+
+
+bool VulkanInitializeResources()
+{
+	// Shader modules are kept, the pipeline is created again when a session picks different swapchain formats
+	vulkanVertexShaderModule = VulkanCreateShaderModule(cubeVertexShaderSpirv, sizeof(cubeVertexShaderSpirv));
+	vulkanFragmentShaderModule = VulkanCreateShaderModule(cubeFragmentShaderSpirv, sizeof(cubeFragmentShaderSpirv));
+
+
+	// Both matrices are passed as push constants, 128 bytes is the minimum every implementation supports
+	{
+		VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VulkanPushConstants) };
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		vkCreatePipelineLayout(vulkanDevice, &pipelineLayoutInfo, nullptr, &vulkanPipelineLayout);
+	}
+
+
+	// Create GPU resources for our mesh's vertices and indices
+	{
+		if (!VulkanCreateBuffer(cubeVertices, sizeof(cubeVertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vulkanVertexBuffer, vulkanVertexBufferMemory) ||
+			!VulkanCreateBuffer(cubeIndices, sizeof(cubeIndices), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, vulkanIndexBuffer, vulkanIndexBufferMemory))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool VulkanSetSwapchainFormats(int64_t colorFormat, int64_t depthFormat)
+{
+	// Render passes and pipeline from an earlier session can be kept when the formats did not change
+	{
+		if (vulkanPipeline != VK_NULL_HANDLE && colorFormat == vulkanColorFormat && depthFormat == vulkanDepthFormat)
+		{
+			return true;
+		}
+
+		vkDeviceWaitIdle(vulkanDevice);
+		vkDestroyPipeline(vulkanDevice, vulkanPipeline, nullptr);
+		vkDestroyRenderPass(vulkanDevice, vulkanRenderPass, nullptr);
+		vkDestroyRenderPass(vulkanDevice, vulkanRenderPassStoreDepth, nullptr);
+		vulkanPipeline = VK_NULL_HANDLE;
+		vulkanRenderPass = VK_NULL_HANDLE;
+		vulkanRenderPassStoreDepth = VK_NULL_HANDLE;
+
+		vulkanColorFormat = (VkFormat)colorFormat;
+		vulkanDepthFormat = (VkFormat)depthFormat;
+	}
+
+
+	// Depth is only stored when it is submitted to the runtime, both passes are otherwise the same and share the pipeline
+	for (VkRenderPass* renderPass : { &vulkanRenderPass, &vulkanRenderPassStoreDepth })
+	{
+		VkAttachmentDescription attachments[2] = {};
+		attachments[0].format = vulkanColorFormat;
+		attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; // Layout the runtime expects released color images in
+
+		attachments[1].format = vulkanDepthFormat;
+		attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachments[1].storeOp = renderPass == &vulkanRenderPassStoreDepth ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL; // Layout the runtime expects released depth images in
+
+		VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference depthReference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+		VkSubpassDescription subpass = {};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments = &colorReference;
+		subpass.pDepthStencilAttachment = &depthReference;
+
+		VkRenderPassCreateInfo renderPassInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+		renderPassInfo.attachmentCount = (uint32_t)size(attachments);
+		renderPassInfo.pAttachments = attachments;
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+
+		if (vkCreateRenderPass(vulkanDevice, &renderPassInfo, nullptr, renderPass) != VK_SUCCESS)
+		{
+			return false;
+		}
+	}
+
+
+	// Create graphics pipeline with the same fixed function state as the Direct3D 11 defaults
+	{
+		// Specialize the fragment shader for sRGB targets, see Shaders/Cube.frag
+		const VkBool32 srgbTarget = vulkanColorFormat == VK_FORMAT_R8G8B8A8_SRGB || vulkanColorFormat == VK_FORMAT_B8G8R8A8_SRGB;
+		VkSpecializationMapEntry specializationEntry = { 0, 0, sizeof(srgbTarget) };
+		VkSpecializationInfo specializationInfo = { 1, &specializationEntry, sizeof(srgbTarget), &srgbTarget };
+
+		VkPipelineShaderStageCreateInfo stages[2] = {};
+		stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		stages[0].module = vulkanVertexShaderModule;
+		stages[0].pName = "main";
+		stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		stages[1].module = vulkanFragmentShaderModule;
+		stages[1].pName = "main";
+		stages[1].pSpecializationInfo = &specializationInfo;
+
+
+		// Describe how our mesh is laid out in memory
+		VkVertexInputBindingDescription vertexBinding = { 0, cubeVertexStride, VK_VERTEX_INPUT_RATE_VERTEX };
+		VkVertexInputAttributeDescription vertexAttributes[] =
+		{
+			{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+			{ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 },
+		};
+
+		VkPipelineVertexInputStateCreateInfo vertexInputState = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+		vertexInputState.vertexBindingDescriptionCount = 1;
+		vertexInputState.pVertexBindingDescriptions = &vertexBinding;
+		vertexInputState.vertexAttributeDescriptionCount = (uint32_t)size(vertexAttributes);
+		vertexInputState.pVertexAttributeDescriptions = vertexAttributes;
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
+		inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+		VkPipelineViewportStateCreateInfo viewportState = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+
+		// Clockwise triangles in framebuffer space are front facing, as with the Direct3D default rasterizer state
+		VkPipelineRasterizationStateCreateInfo rasterizationState = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+		rasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+		rasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
+		rasterizationState.lineWidth = 1.0f;
+
+		VkPipelineMultisampleStateCreateInfo multisampleState = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
+		multisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkPipelineDepthStencilStateCreateInfo depthStencilState = { VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
+		depthStencilState.depthTestEnable = VK_TRUE;
+		depthStencilState.depthWriteEnable = VK_TRUE;
+		depthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+		VkPipelineColorBlendStateCreateInfo colorBlendState = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
+		colorBlendState.attachmentCount = 1;
+		colorBlendState.pAttachments = &colorBlendAttachment;
+
+
+		// Viewport and scissor follow the image rect of every view
+		VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		VkPipelineDynamicStateCreateInfo dynamicState = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+		dynamicState.dynamicStateCount = (uint32_t)size(dynamicStates);
+		dynamicState.pDynamicStates = dynamicStates;
+
+		VkGraphicsPipelineCreateInfo pipelineInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+		pipelineInfo.stageCount = (uint32_t)size(stages);
+		pipelineInfo.pStages = stages;
+		pipelineInfo.pVertexInputState = &vertexInputState;
+		pipelineInfo.pInputAssemblyState = &inputAssemblyState;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizationState;
+		pipelineInfo.pMultisampleState = &multisampleState;
+		pipelineInfo.pDepthStencilState = &depthStencilState;
+		pipelineInfo.pColorBlendState = &colorBlendState;
+		pipelineInfo.pDynamicState = &dynamicState;
+		pipelineInfo.layout = vulkanPipelineLayout;
+		pipelineInfo.renderPass = vulkanRenderPass;
+
+		VkResult result = vkCreateGraphicsPipelines(vulkanDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &vulkanPipeline);
+		if (result != VK_SUCCESS)
+		{
+			printf("Error: vkCreateGraphicsPipelines failed %d\n", (int)result);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+const char* VulkanFormatName(int64_t format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_R8G8B8A8_SRGB: return "VK_FORMAT_R8G8B8A8_SRGB";
+	case VK_FORMAT_B8G8R8A8_SRGB: return "VK_FORMAT_B8G8R8A8_SRGB";
+	case VK_FORMAT_R8G8B8A8_UNORM: return "VK_FORMAT_R8G8B8A8_UNORM";
+	case VK_FORMAT_B8G8R8A8_UNORM: return "VK_FORMAT_B8G8R8A8_UNORM";
+	case VK_FORMAT_D32_SFLOAT: return "VK_FORMAT_D32_SFLOAT";
+	case VK_FORMAT_D24_UNORM_S8_UINT: return "VK_FORMAT_D24_UNORM_S8_UINT";
+	case VK_FORMAT_D16_UNORM: return "VK_FORMAT_D16_UNORM";
+	case VK_FORMAT_D32_SFLOAT_S8_UINT: return "VK_FORMAT_D32_SFLOAT_S8_UINT";
+	default: return "unknown Vulkan format";
+	}
+}
+
+
+size_t VulkanFramebufferIndex(const VulkanSwapchainImages& swapchainImages, uint32_t imageId, uint32_t depthImageId)
+{
+	// The runtime hands out color and depth images independently, so there is a framebuffer for every pair of them
+	if (swapchainImages.xrDepthSwapchainImages.empty())
+	{
+		return imageId;
+	}
+	return (size_t)imageId * swapchainImages.xrDepthSwapchainImages.size() + depthImageId;
+}
+
+
+bool VulkanCreateSwapchainImages(uint32_t viewIndex, XrSwapchain xrSwapchain, XrSwapchain xrDepthSwapchain, int32_t width, int32_t height)
+{
+	uint32_t swapchainLength = 0;
+	uint32_t depthSwapchainLength = 0;
+
+	if (vulkanSwapchainImages.size() <= viewIndex)
+	{
+		vulkanSwapchainImages.resize(viewIndex + 1);
+	}
+
+	VulkanSwapchainImages& swapchainImages = vulkanSwapchainImages[viewIndex];
+
+
+	// Find out how many images were generated for the swapchains by device runtime and cache them
+	{
+		xrEnumerateSwapchainImages(xrSwapchain, 0, &swapchainLength, nullptr);
+		swapchainImages.xrSwapchainImages.resize(swapchainLength, { XR_TYPE_SWAPCHAIN_IMAGE_VULKAN2_KHR });
+		xrEnumerateSwapchainImages(xrSwapchain, swapchainLength, &swapchainLength, (XrSwapchainImageBaseHeader*)swapchainImages.xrSwapchainImages.data());
+
+		if (xrDepthSwapchain != XR_NULL_HANDLE)
+		{
+			xrEnumerateSwapchainImages(xrDepthSwapchain, 0, &depthSwapchainLength, nullptr);
+			swapchainImages.xrDepthSwapchainImages.resize(depthSwapchainLength, { XR_TYPE_SWAPCHAIN_IMAGE_VULKAN2_KHR });
+			xrEnumerateSwapchainImages(xrDepthSwapchain, depthSwapchainLength, &depthSwapchainLength, (XrSwapchainImageBaseHeader*)swapchainImages.xrDepthSwapchainImages.data());
+		}
+
+		swapchainImages.colorViews.resize(swapchainLength);
+		if (xrDepthSwapchain == XR_NULL_HANDLE)
+		{
+			swapchainImages.depthImages.resize(swapchainLength);
+			swapchainImages.depthMemories.resize(swapchainLength);
+		}
+		swapchainImages.depthViews.resize(xrDepthSwapchain != XR_NULL_HANDLE ? depthSwapchainLength : swapchainLength);
+		swapchainImages.framebuffers.resize(xrDepthSwapchain != XR_NULL_HANDLE ? swapchainLength * depthSwapchainLength : swapchainLength);
+	}
+
+
+	// Create color view for every swapchain image
+	for (uint32_t i = 0; i < swapchainLength; i++)
+	{
+		VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		viewInfo.image = swapchainImages.xrSwapchainImages[i].image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = vulkanColorFormat;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vkCreateImageView(vulkanDevice, &viewInfo, nullptr, &swapchainImages.colorViews[i]);
+	}
+
+
+	// Create image and memory for our own depth buffers, when there is no depth swapchain to render depth into
+	for (uint32_t i = 0; i < swapchainImages.depthImages.size(); i++)
+	{
+		VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = vulkanDepthFormat;
+		imageInfo.extent = { (uint32_t)width, (uint32_t)height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		vkCreateImage(vulkanDevice, &imageInfo, nullptr, &swapchainImages.depthImages[i]);
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(vulkanDevice, swapchainImages.depthImages[i], &memoryRequirements);
+
+		VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		allocateInfo.allocationSize = memoryRequirements.size;
+		if (!VulkanFindMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocateInfo.memoryTypeIndex) ||
+			vkAllocateMemory(vulkanDevice, &allocateInfo, nullptr, &swapchainImages.depthMemories[i]) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		vkBindImageMemory(vulkanDevice, swapchainImages.depthImages[i], swapchainImages.depthMemories[i], 0);
+	}
+
+
+	// Create depth view for every depth buffer, either ours or the runtime's depth swapchain images
+	const VkImageAspectFlags depthAspect = vulkanDepthFormat == VK_FORMAT_D24_UNORM_S8_UINT || vulkanDepthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT ?
+		VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+	for (uint32_t i = 0; i < swapchainImages.depthViews.size(); i++)
+	{
+		VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		viewInfo.image = xrDepthSwapchain != XR_NULL_HANDLE ? swapchainImages.xrDepthSwapchainImages[i].image : swapchainImages.depthImages[i];
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = vulkanDepthFormat;
+		viewInfo.subresourceRange = { depthAspect, 0, 1, 0, 1 };
+		vkCreateImageView(vulkanDevice, &viewInfo, nullptr, &swapchainImages.depthViews[i]);
+	}
+
+
+	// Create framebuffer binding color and depth views to the render pass, for every pair that can be acquired together
+	for (uint32_t i = 0; i < swapchainLength; i++)
+	{
+		for (uint32_t j = 0; j < swapchainImages.depthViews.size(); j++)
+		{
+			if (xrDepthSwapchain == XR_NULL_HANDLE && j != i)
+			{
+				continue;
+			}
+
+			VkImageView attachments[] = { swapchainImages.colorViews[i], swapchainImages.depthViews[j] };
+
+			VkFramebufferCreateInfo framebufferInfo = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+			framebufferInfo.renderPass = vulkanRenderPass;
+			framebufferInfo.attachmentCount = (uint32_t)size(attachments);
+			framebufferInfo.pAttachments = attachments;
+			framebufferInfo.width = (uint32_t)width;
+			framebufferInfo.height = (uint32_t)height;
+			framebufferInfo.layers = 1;
+			vkCreateFramebuffer(vulkanDevice, &framebufferInfo, nullptr, &swapchainImages.framebuffers[VulkanFramebufferIndex(swapchainImages, i, j)]);
+		}
+	}
+
+
+	// Create command buffer and fence used to render this view, the fence starts signaled as nothing is pending yet
+	{
+		VkCommandBufferAllocateInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		commandBufferInfo.commandPool = vulkanCommandPool;
+		commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferInfo.commandBufferCount = 1;
+		vkAllocateCommandBuffers(vulkanDevice, &commandBufferInfo, &swapchainImages.commandBuffer);
+
+		VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+		vkCreateFence(vulkanDevice, &fenceInfo, nullptr, &swapchainImages.fence);
+	}
+
+	return true;
+}
+
+
+void VulkanDestroySwapchain(VulkanSwapchainImages& swapchain)
+{
+	vkDeviceWaitIdle(vulkanDevice);
+
+	for (VkFramebuffer framebuffer : swapchain.framebuffers)
+	{
+		vkDestroyFramebuffer(vulkanDevice, framebuffer, nullptr);
+	}
+	for (VkImageView depthView : swapchain.depthViews)
+	{
+		vkDestroyImageView(vulkanDevice, depthView, nullptr);
+	}
+	for (uint32_t i = 0; i < swapchain.depthImages.size(); i++)
+	{
+		vkDestroyImage(vulkanDevice, swapchain.depthImages[i], nullptr);
+		vkFreeMemory(vulkanDevice, swapchain.depthMemories[i], nullptr);
+	}
+	for (VkImageView colorView : swapchain.colorViews)
+	{
+		vkDestroyImageView(vulkanDevice, colorView, nullptr);
+	}
+
+	vkFreeCommandBuffers(vulkanDevice, vulkanCommandPool, 1, &swapchain.commandBuffer);
+	vkDestroyFence(vulkanDevice, swapchain.fence, nullptr);
+
+	swapchain = {};
+}
+
+
+void VulkanRenderView(uint32_t viewIndex, uint32_t imageId, uint32_t depthImageId, const XrRect2Di& rect, const Float4x4& viewProjection, const vector<Float4x4>& models)
+{
+	VulkanSwapchainImages& swapchainImages = vulkanSwapchainImages[viewIndex];
+	VkCommandBuffer commandBuffer = swapchainImages.commandBuffer;
+
+
+	// Wait until the commands recorded for this view last frame have finished before recording again
+	{
+		vkWaitForFences(vulkanDevice, 1, &swapchainImages.fence, VK_TRUE, UINT64_MAX);
+		vkResetFences(vulkanDevice, 1, &swapchainImages.fence);
+		vkResetCommandBuffer(commandBuffer, 0);
+
+		VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	}
+
+
+	// Clear swapchain color and depth attachments as the render pass begins, depth is kept when the runtime reads it
+	{
+		VkClearValue clearValues[2];
+		clearValues[0].color = { { 0, 0, 0, 1 } };
+		clearValues[1].depthStencil = { 1.0f, 0 };
+
+		VkRenderPassBeginInfo renderPassBeginInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+		renderPassBeginInfo.renderPass = swapchainImages.xrDepthSwapchainImages.empty() ? vulkanRenderPass : vulkanRenderPassStoreDepth;
+		renderPassBeginInfo.framebuffer = swapchainImages.framebuffers[VulkanFramebufferIndex(swapchainImages, imageId, depthImageId)];
+		renderPassBeginInfo.renderArea = { { rect.offset.x, rect.offset.y }, { (uint32_t)rect.extent.width, (uint32_t)rect.extent.height } };
+		renderPassBeginInfo.clearValueCount = (uint32_t)size(clearValues);
+		renderPassBeginInfo.pClearValues = clearValues;
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	}
+
+
+	// Set viewport we will render onto with same swapchain image dimension
+	{
+		VkViewport viewport = { (float)rect.offset.x, (float)rect.offset.y, (float)rect.extent.width, (float)rect.extent.height, 0.0f, 1.0f };
+		VkRect2D scissor = { { rect.offset.x, rect.offset.y }, { (uint32_t)rect.extent.width, (uint32_t)rect.extent.height } };
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	}
+
+
+	// Bind pipeline and hook cube mesh vertex buffer and index buffer
+	{
+		VkDeviceSize offset = 0;
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkanPipeline);
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vulkanVertexBuffer, &offset);
+		vkCmdBindIndexBuffer(commandBuffer, vulkanIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	}
+
+
+	// Push view projection matrix once, then every cube's model matrix and draw cube triangles
+	{
+		vkCmdPushConstants(commandBuffer, vulkanPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offsetof(VulkanPushConstants, ViewProjection), sizeof(Float4x4), &viewProjection);
+
+		for (size_t i = 0; i < models.size(); i++)
+		{
+			vkCmdPushConstants(commandBuffer, vulkanPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offsetof(VulkanPushConstants, Model), sizeof(Float4x4), &models[i]);
+			vkCmdDrawIndexed(commandBuffer, cubeIndexCount, 1, 0, 0, 0);
+		}
+	}
+
+
+	// Submit to the queue the runtime was given, it synchronizes with it before using the image
+	{
+		vkCmdEndRenderPass(commandBuffer);
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		vkQueueSubmit(vulkanQueue, 1, &submitInfo, swapchainImages.fence);
+	}
+}
+
+
+void VulkanShutdown()
+{
+	if (vulkanDevice)
+	{
+		vkDeviceWaitIdle(vulkanDevice);
+
+		vkDestroyBuffer(vulkanDevice, vulkanVertexBuffer, nullptr);
+		vkFreeMemory(vulkanDevice, vulkanVertexBufferMemory, nullptr);
+		vkDestroyBuffer(vulkanDevice, vulkanIndexBuffer, nullptr);
+		vkFreeMemory(vulkanDevice, vulkanIndexBufferMemory, nullptr);
+		vkDestroyPipeline(vulkanDevice, vulkanPipeline, nullptr);
+		vkDestroyShaderModule(vulkanDevice, vulkanVertexShaderModule, nullptr);
+		vkDestroyShaderModule(vulkanDevice, vulkanFragmentShaderModule, nullptr);
+		vkDestroyPipelineLayout(vulkanDevice, vulkanPipelineLayout, nullptr);
+		vkDestroyRenderPass(vulkanDevice, vulkanRenderPass, nullptr);
+		vkDestroyRenderPass(vulkanDevice, vulkanRenderPassStoreDepth, nullptr);
+		vkDestroyCommandPool(vulkanDevice, vulkanCommandPool, nullptr);
+
+		vkDestroyDevice(vulkanDevice, nullptr);
+		vulkanDevice = VK_NULL_HANDLE;
+	}
+	if (vulkanInstance)
+	{
+		vkDestroyInstance(vulkanInstance, nullptr);
+		vulkanInstance = VK_NULL_HANDLE;
+	}
+}
+
+
+struct VulkanRenderBackend : RenderBackend {
+	const char* GetRenderingExtension() override { return XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME; }
+	bool CreateDevice(XrInstance instance, XrSystemId systemId) override { return VulkanCreateDevice(instance, systemId); }
+	const void* GetGraphicsBinding() override { return &xrVulkanGraphicsBinding; }
+	const vector<int64_t>& GetSwapchainFormats() override { return vulkanColorFormats; }
+	const vector<int64_t>& GetDepthSwapchainFormats() override { return vulkanDepthFormats; }
+	bool SetSwapchainFormats(int64_t colorFormat, int64_t depthFormat) override { return VulkanSetSwapchainFormats(colorFormat, depthFormat); }
+	const char* GetFormatName(int64_t format) override { return VulkanFormatName(format); }
+	bool CompileShaders() override { return true; } // SPIR-V is compiled at build time
+	bool InitializeResources() override { return VulkanInitializeResources(); }
+	bool CreateSwapchainImages(uint32_t viewIndex, XrSwapchain swapchain, XrSwapchain depthSwapchain, int32_t width, int32_t height) override { return VulkanCreateSwapchainImages(viewIndex, swapchain, depthSwapchain, width, height); }
+	void DestroySwapchainImages(uint32_t viewIndex) override { VulkanDestroySwapchain(vulkanSwapchainImages[viewIndex]); }
+	Float4x4 GetProjectionMatrix(const XrFovf& fov, float clipNear, float clipFar) override { return ProjectionFromFovFlipY(*(const Fov*)&fov, clipNear, clipFar); }
+	void RenderView(uint32_t viewIndex, uint32_t imageIndex, uint32_t depthImageIndex, const XrRect2Di& imageRect, const Float4x4& viewProjection, const vector<Float4x4>& models) override { VulkanRenderView(viewIndex, imageIndex, depthImageIndex, imageRect, viewProjection, models); }
+	void Shutdown() override { VulkanShutdown(); }
+};
+
+
+RenderBackend* CreateVulkanRenderBackend()
+{
+	return new VulkanRenderBackend();
+}
@@ -0,0 +1,18 @@
+#version 450
+
+// Set when the swapchain has an sRGB format, it encodes on write so the sRGB vertex colors have to be linear first
+layout(constant_id = 0) const bool SrgbTarget = false;
+
+layout(location = 0) in vec3 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	vec3 color = inColor;
+	if (SrgbTarget)
+	{
+		color = mix(color / 12.92, pow((color + 0.055) / 1.055, vec3(2.4)), greaterThan(color, vec3(0.04045)));
+	}
+	outColor = vec4(color, 1);
+}
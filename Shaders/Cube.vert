@@ -0,0 +1,20 @@
+#version 450
+
+// GLSL version of the HLSL cube shader in RenderBackendD3D11.cpp, compiled to SPIR-V at build time for the Vulkan backend
+
+layout(push_constant) uniform PushConstants
+{
+	mat4 Model;
+	mat4 ViewProjection;
+} pushConstants;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 outColor;
+
+void main()
+{
+	gl_Position = pushConstants.ViewProjection * pushConstants.Model * vec4(inPosition, 1);
+	outColor = inColor;
+}
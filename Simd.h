@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+
+// Four wide float operations for the CPU rendering paths. Uses SSE2 on x86/x64, NEON on ARM (HoloLens 2 is ARM64)
+// and plain arrays everywhere else, so the same code runs on every platform the app is built for.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64) || defined(_M_ARM)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+
+#if defined(SIMD_SSE2)
+
+typedef __m128 SimdFloat;
+typedef __m128 SimdMask;
+
+inline SimdFloat SimdSet(float value) { return _mm_set1_ps(value); }
+inline SimdFloat SimdSet(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+inline SimdFloat SimdLoad(const float* values) { return _mm_loadu_ps(values); }
+inline void SimdStore(float* values, SimdFloat a) { _mm_storeu_ps(values, a); }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return _mm_add_ps(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { return _mm_div_ps(a, b); }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { return _mm_min_ps(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return _mm_max_ps(a, b); }
+inline SimdMask SimdGreater(SimdFloat a, SimdFloat b) { return _mm_cmpgt_ps(a, b); }
+inline SimdMask SimdGreaterEqual(SimdFloat a, SimdFloat b) { return _mm_cmpge_ps(a, b); }
+inline SimdMask SimdLess(SimdFloat a, SimdFloat b) { return _mm_cmplt_ps(a, b); }
+inline SimdMask SimdAnd(SimdMask a, SimdMask b) { return _mm_and_ps(a, b); }
+inline SimdMask SimdOr(SimdMask a, SimdMask b) { return _mm_or_ps(a, b); }
+inline SimdMask SimdMaskFromBits(int bits) { return _mm_castsi128_ps(_mm_setr_epi32(bits & 1 ? -1 : 0, bits & 2 ? -1 : 0, bits & 4 ? -1 : 0, bits & 8 ? -1 : 0)); }
+inline SimdFloat SimdSelect(SimdMask mask, SimdFloat a, SimdFloat b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline int SimdMoveMask(SimdMask mask) { return _mm_movemask_ps(mask); }
+
+#elif defined(SIMD_NEON)
+
+typedef float32x4_t SimdFloat;
+typedef uint32x4_t SimdMask;
+
+inline SimdFloat SimdSet(float value) { return vdupq_n_f32(value); }
+inline SimdFloat SimdSet(float a, float b, float c, float d) { const float values[4] = { a, b, c, d }; return vld1q_f32(values); }
+inline SimdFloat SimdLoad(const float* values) { return vld1q_f32(values); }
+inline void SimdStore(float* values, SimdFloat a) { vst1q_f32(values, a); }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return vaddq_f32(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return vsubq_f32(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return vmulq_f32(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b)
+{
+	// Two Newton-Raphson steps on the reciprocal estimate are plenty for interpolated colors and depth
+	float32x4_t reciprocal = vrecpeq_f32(b);
+	reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+	reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+	return vmulq_f32(a, reciprocal);
+}
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { return vminq_f32(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return vmaxq_f32(a, b); }
+inline SimdMask SimdGreater(SimdFloat a, SimdFloat b) { return vcgtq_f32(a, b); }
+inline SimdMask SimdGreaterEqual(SimdFloat a, SimdFloat b) { return vcgeq_f32(a, b); }
+inline SimdMask SimdLess(SimdFloat a, SimdFloat b) { return vcltq_f32(a, b); }
+inline SimdMask SimdAnd(SimdMask a, SimdMask b) { return vandq_u32(a, b); }
+inline SimdMask SimdOr(SimdMask a, SimdMask b) { return vorrq_u32(a, b); }
+inline SimdMask SimdMaskFromBits(int bits) { const uint32_t values[4] = { bits & 1 ? ~0u : 0, bits & 2 ? ~0u : 0, bits & 4 ? ~0u : 0, bits & 8 ? ~0u : 0 }; return vld1q_u32(values); }
+inline SimdFloat SimdSelect(SimdMask mask, SimdFloat a, SimdFloat b) { return vbslq_f32(mask, a, b); }
+inline int SimdMoveMask(SimdMask mask)
+{
+	const uint32x4_t bits = { 1, 2, 4, 8 };
+	return (int)vaddvq_u32(vandq_u32(mask, bits));
+}
+
+#else
+
+struct SimdFloat {
+	float lane[4];
+};
+
+struct SimdMask {
+	bool lane[4];
+};
+
+inline SimdFloat SimdSet(float value) { return { { value, value, value, value } }; }
+inline SimdFloat SimdSet(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+inline SimdFloat SimdLoad(const float* values) { return { { values[0], values[1], values[2], values[3] } }; }
+inline void SimdStore(float* values, SimdFloat a) { for (int i = 0; i < 4; i++) values[i] = a.lane[i]; }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { for (int i = 0; i < 4; i++) a.lane[i] += b.lane[i]; return a; }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { for (int i = 0; i < 4; i++) a.lane[i] -= b.lane[i]; return a; }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { for (int i = 0; i < 4; i++) a.lane[i] *= b.lane[i]; return a; }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { for (int i = 0; i < 4; i++) a.lane[i] /= b.lane[i]; return a; }
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { for (int i = 0; i < 4; i++) a.lane[i] = b.lane[i] < a.lane[i] ? b.lane[i] : a.lane[i]; return a; }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { for (int i = 0; i < 4; i++) a.lane[i] = b.lane[i] > a.lane[i] ? b.lane[i] : a.lane[i]; return a; }
+inline SimdMask SimdGreater(SimdFloat a, SimdFloat b) { SimdMask m; for (int i = 0; i < 4; i++) m.lane[i] = a.lane[i] > b.lane[i]; return m; }
+inline SimdMask SimdGreaterEqual(SimdFloat a, SimdFloat b) { SimdMask m; for (int i = 0; i < 4; i++) m.lane[i] = a.lane[i] >= b.lane[i]; return m; }
+inline SimdMask SimdLess(SimdFloat a, SimdFloat b) { SimdMask m; for (int i = 0; i < 4; i++) m.lane[i] = a.lane[i] < b.lane[i]; return m; }
+inline SimdMask SimdAnd(SimdMask a, SimdMask b) { for (int i = 0; i < 4; i++) a.lane[i] = a.lane[i] && b.lane[i]; return a; }
+inline SimdMask SimdOr(SimdMask a, SimdMask b) { for (int i = 0; i < 4; i++) a.lane[i] = a.lane[i] || b.lane[i]; return a; }
+inline SimdMask SimdMaskFromBits(int bits) { SimdMask m; for (int i = 0; i < 4; i++) m.lane[i] = (bits & (1 << i)) != 0; return m; }
+inline SimdFloat SimdSelect(SimdMask mask, SimdFloat a, SimdFloat b) { for (int i = 0; i < 4; i++) a.lane[i] = mask.lane[i] ? a.lane[i] : b.lane[i]; return a; }
+inline int SimdMoveMask(SimdMask mask) { return (mask.lane[0] ? 1 : 0) | (mask.lane[1] ? 2 : 0) | (mask.lane[2] ? 4 : 0) | (mask.lane[3] ? 8 : 0); }
+
+#endif
@@ -0,0 +1,458 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Simd.h"
+#include "JobSystem.h"
+
+using namespace std;
+
+
+// Clip space vertex with the attributes the cube shader passes from vertex to pixel shader
+struct SoftwareClipVertex {
+	float x, y, z, w;
+	float r, g, b;
+};
+
+
+////////////////////////////////////////////////
+// Software rasterizer
+////////////////////////////////////////////////
+
+void SoftwareRasterizerInitialize(SoftwareRasterizer& rasterizer)
+{
+	// A few ranges per job thread so ranges with many visible triangles can be balanced by work stealing
+	rasterizer.binCount = JobSystemThreadCount() * 4;
+	rasterizer.tilesX = 0;
+	rasterizer.tilesY = 0;
+	rasterizer.triangles.assign(rasterizer.binCount, {});
+	rasterizer.tileTriangles.assign(rasterizer.binCount, {});
+	rasterizer.binStats.assign(rasterizer.binCount, {});
+}
+
+
+void SoftwareCreateRenderTarget(SoftwareRenderTarget& target, int32_t width, int32_t height)
+{
+	// Rows are padded to a multiple of 4 pixels so the rasterizer can always load and store whole SIMD groups
+	target.width = width;
+	target.height = height;
+	target.stride = (width + 3) & ~3;
+	target.color.assign((size_t)target.stride * height, 0);
+	target.depth.assign((size_t)target.stride * height, 1.0f);
+}
+
+
+void SoftwareClear(SoftwareRenderTarget& target, const float color[4], float depth)
+{
+	uint32_t packed = 0;
+	for (int channel = 0; channel < 4; channel++)
+	{
+		const float value = min(max(color[channel], 0.0f), 1.0f);
+		packed |= (uint32_t)(value * 255.0f + 0.5f) << (channel * 8);
+	}
+
+	fill(target.color.begin(), target.color.end(), packed);
+	fill(target.depth.begin(), target.depth.end(), depth);
+}
+
+
+// Plane a*x + b*y + c through the three vertex values of an attribute, given the edge functions of the triangle
+void SoftwareAttributePlane(const SoftwareTriangle& triangle, const float values[3], float inverseArea, float plane[3])
+{
+	plane[0] = (triangle.edgeA[0] * values[0] + triangle.edgeA[1] * values[1] + triangle.edgeA[2] * values[2]) * inverseArea;
+	plane[1] = (triangle.edgeB[0] * values[0] + triangle.edgeB[1] * values[1] + triangle.edgeB[2] * values[2]) * inverseArea;
+	plane[2] = (triangle.edgeC[0] * values[0] + triangle.edgeC[1] * values[1] + triangle.edgeC[2] * values[2]) * inverseArea;
+}
+
+
+// Project a clipped triangle to the screen, cull it, set it up for rasterization and add it to the bins of every tile it touches
+void SoftwareSetupTriangle(SoftwareRasterizer& rasterizer, uint32_t bin, const SoftwareRenderTarget& target, const SoftwareClipVertex* vertices[3])
+{
+	float x[3], y[3], z[3], inverseW[3];
+
+	// Perspective divide and viewport transform, snapped to 1/256 of a pixel like GPUs do so the fill rules are exact
+	for (int i = 0; i < 3; i++)
+	{
+		inverseW[i] = 1.0f / vertices[i]->w;
+		x[i] = roundf((vertices[i]->x * inverseW[i] * 0.5f + 0.5f) * target.width * 256.0f) * (1.0f / 256.0f);
+		y[i] = roundf((0.5f - vertices[i]->y * inverseW[i] * 0.5f) * target.height * 256.0f) * (1.0f / 256.0f);
+		z[i] = vertices[i]->z * inverseW[i];
+	}
+
+
+	// Cull back faces. Like the D3D11 default rasterizer state, clockwise triangles on screen are front facing
+	const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (!(area > 0))
+		return;
+
+
+	// Pixels whose centers can be covered, skip triangles that fall between pixel centers
+	SoftwareTriangle triangle;
+	triangle.minX = max(0, (int32_t)ceilf(min({ x[0], x[1], x[2] }) - 0.5f));
+	triangle.minY = max(0, (int32_t)ceilf(min({ y[0], y[1], y[2] }) - 0.5f));
+	triangle.maxX = min(target.width - 1, (int32_t)floorf(max({ x[0], x[1], x[2] }) - 0.5f));
+	triangle.maxY = min(target.height - 1, (int32_t)floorf(max({ y[0], y[1], y[2] }) - 0.5f));
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+		return;
+
+
+	// Edge functions, edge i is opposite of vertex i and positive inside the triangle
+	for (int i = 0; i < 3; i++)
+	{
+		const int a = (i + 1) % 3;
+		const int b = (i + 2) % 3;
+		const float dx = x[b] - x[a];
+		const float dy = y[b] - y[a];
+
+		triangle.edgeA[i] = -dy;
+		triangle.edgeB[i] = dx;
+		triangle.edgeC[i] = dy * x[a] - dx * y[a];
+
+		// Top-left fill rule, pixel centers exactly on an edge belong to the triangle if it is a top or left edge
+		triangle.edgeTopLeft[i] = dy < 0 || (dy == 0 && dx > 0);
+	}
+
+
+	// Depth is interpolated linearly in screen space, color perspective correct through 1/w
+	{
+		const float inverseArea = 1.0f / area;
+		SoftwareAttributePlane(triangle, z, inverseArea, triangle.depth);
+		SoftwareAttributePlane(triangle, inverseW, inverseArea, triangle.inverseW);
+
+		for (int channel = 0; channel < 3; channel++)
+		{
+			const float colorOverW[3] = {
+				(&vertices[0]->r)[channel] * inverseW[0],
+				(&vertices[1]->r)[channel] * inverseW[1],
+				(&vertices[2]->r)[channel] * inverseW[2],
+			};
+			SoftwareAttributePlane(triangle, colorOverW, inverseArea, triangle.colorOverW[channel]);
+		}
+	}
+
+
+	// Bin into every tile the bounds overlap
+	{
+		vector<SoftwareTriangle>& triangles = rasterizer.triangles[bin];
+		vector<vector<uint32_t>>& tileTriangles = rasterizer.tileTriangles[bin];
+		const uint32_t triangleIndex = (uint32_t)triangles.size();
+		triangles.push_back(triangle);
+
+		for (int32_t tileY = triangle.minY / softwareTileSize; tileY <= triangle.maxY / softwareTileSize; tileY++)
+		{
+			for (int32_t tileX = triangle.minX / softwareTileSize; tileX <= triangle.maxX / softwareTileSize; tileX++)
+			{
+				tileTriangles[tileY * rasterizer.tilesX + tileX].push_back(triangleIndex);
+			}
+		}
+		rasterizer.binStats[bin].trianglesRasterized++;
+	}
+}
+
+
+// Clip a triangle against the near (z >= 0) and far (z <= w) planes and set up the resulting fan.
+// Triangles are not clipped against the side planes, the rasterizer bounds take care of those.
+void SoftwareClipTriangle(SoftwareRasterizer& rasterizer, uint32_t bin, const SoftwareRenderTarget& target, const SoftwareClipVertex triangle[3])
+{
+	// Trivially reject triangles fully outside of one of the frustum planes
+	uint32_t outsideAll = 0x3F, outsideAny = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const SoftwareClipVertex& v = triangle[i];
+		const uint32_t outside =
+			(v.x < -v.w ? 0x01 : 0) | (v.x > v.w ? 0x02 : 0) |
+			(v.y < -v.w ? 0x04 : 0) | (v.y > v.w ? 0x08 : 0) |
+			(v.z < 0 ? 0x10 : 0) | (v.z > v.w ? 0x20 : 0);
+		outsideAll &= outside;
+		outsideAny |= outside;
+	}
+	if (outsideAll)
+		return;
+
+	if (!(outsideAny & 0x30))
+	{
+		const SoftwareClipVertex* vertices[3] = { &triangle[0], &triangle[1], &triangle[2] };
+		SoftwareSetupTriangle(rasterizer, bin, target, vertices);
+		return;
+	}
+
+
+	// Sutherland-Hodgman against the two depth planes, a triangle becomes a polygon with at most 5 vertices
+	SoftwareClipVertex polygons[2][5];
+	int count = 3;
+	copy(triangle, triangle + 3, polygons[0]);
+
+	for (int plane = 0; plane < 2; plane++)
+	{
+		const SoftwareClipVertex* input = polygons[plane];
+		SoftwareClipVertex* output = polygons[plane ^ 1];
+		int outputCount = 0;
+
+		for (int i = 0; i < count; i++)
+		{
+			const SoftwareClipVertex& a = input[i];
+			const SoftwareClipVertex& b = input[(i + 1) % count];
+			const float distanceA = plane == 0 ? a.z : a.w - a.z;
+			const float distanceB = plane == 0 ? b.z : b.w - b.z;
+
+			if (distanceA >= 0)
+				output[outputCount++] = a;
+
+			if ((distanceA >= 0) != (distanceB >= 0))
+			{
+				const float t = distanceA / (distanceA - distanceB);
+				const float* from = &a.x;
+				const float* to = &b.x;
+				float* result = &output[outputCount++].x;
+				for (int attribute = 0; attribute < 7; attribute++)
+				{
+					result[attribute] = from[attribute] + (to[attribute] - from[attribute]) * t;
+				}
+			}
+		}
+
+		count = outputCount;
+		if (count < 3)
+			return;
+	}
+
+	// Two planes means the result is back in the first polygon
+	for (int i = 1; i + 1 < count; i++)
+	{
+		const SoftwareClipVertex* vertices[3] = { &polygons[0][0], &polygons[0][i], &polygons[0][i + 1] };
+		SoftwareSetupTriangle(rasterizer, bin, target, vertices);
+	}
+}
+
+
+// Transform, clip and bin every triangle of a range of instances
+void SoftwareTransformInstances(SoftwareRasterizer& rasterizer, uint32_t bin, const SoftwareRenderTarget& target, const SoftwareMesh& mesh, const Float4x4& viewProjection, const Float4x4* models, size_t modelCount)
+{
+	vector<SoftwareClipVertex> clipVertices(mesh.vertexCount);
+
+	for (size_t instance = 0; instance < modelCount; instance++)
+	{
+		// Same as the vertex shader: mul(mul(float4(pos, 1), Model), ViewProjection)
+		const Float4x4 modelViewProjection = MatrixMultiply(models[instance], viewProjection);
+		const float(*m)[4] = modelViewProjection.m;
+
+		for (uint32_t i = 0; i < mesh.vertexCount; i++)
+		{
+			const float* vertex = mesh.vertices + i * 6;
+			SoftwareClipVertex& clip = clipVertices[i];
+			clip.x = vertex[0] * m[0][0] + vertex[1] * m[1][0] + vertex[2] * m[2][0] + m[3][0];
+			clip.y = vertex[0] * m[0][1] + vertex[1] * m[1][1] + vertex[2] * m[2][1] + m[3][1];
+			clip.z = vertex[0] * m[0][2] + vertex[1] * m[1][2] + vertex[2] * m[2][2] + m[3][2];
+			clip.w = vertex[0] * m[0][3] + vertex[1] * m[1][3] + vertex[2] * m[2][3] + m[3][3];
+			clip.r = vertex[3];
+			clip.g = vertex[4];
+			clip.b = vertex[5];
+		}
+
+		for (uint32_t i = 0; i + 2 < mesh.indexCount; i += 3)
+		{
+			const SoftwareClipVertex triangle[3] = {
+				clipVertices[mesh.indices[i]],
+				clipVertices[mesh.indices[i + 1]],
+				clipVertices[mesh.indices[i + 2]],
+			};
+			SoftwareClipTriangle(rasterizer, bin, target, triangle);
+		}
+		rasterizer.binStats[bin].trianglesSubmitted += mesh.indexCount / 3;
+	}
+}
+
+
+// Fill the part of a triangle that lies inside of one tile, 4 pixels of a row at a time
+void SoftwareRasterizeTriangle(const SoftwareTriangle& triangle, int32_t tileX, int32_t tileY, SoftwareRenderTarget& target, SoftwareRasterizerStats& stats)
+{
+	const int32_t minX = max(triangle.minX, tileX);
+	const int32_t maxX = min(triangle.maxX, tileX + softwareTileSize - 1);
+	const int32_t minY = max(triangle.minY, tileY);
+	const int32_t maxY = min(triangle.maxY, tileY + softwareTileSize - 1);
+
+	const SimdFloat zero = SimdSet(0.0f);
+	const SimdFloat one = SimdSet(1.0f);
+	const SimdFloat laneOffsets = SimdSet(0.5f, 1.5f, 2.5f, 3.5f);
+
+	SimdFloat edgeA[3];
+	for (int i = 0; i < 3; i++)
+	{
+		edgeA[i] = SimdSet(triangle.edgeA[i]);
+	}
+	const SimdFloat depthA = SimdSet(triangle.depth[0]);
+	const SimdFloat inverseWA = SimdSet(triangle.inverseW[0]);
+	SimdFloat colorA[3];
+	for (int channel = 0; channel < 3; channel++)
+	{
+		colorA[channel] = SimdSet(triangle.colorOverW[channel][0]);
+	}
+
+	static const uint8_t laneCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	uint64_t pixelsCovered = 0;
+	uint64_t pixelsWritten = 0;
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		const float pixelY = y + 0.5f;
+
+		// Everything but the x term of the planes is constant along the row
+		SimdFloat edgeRow[3];
+		for (int i = 0; i < 3; i++)
+		{
+			edgeRow[i] = SimdSet(triangle.edgeB[i] * pixelY + triangle.edgeC[i]);
+		}
+		const SimdFloat depthRow = SimdSet(triangle.depth[1] * pixelY + triangle.depth[2]);
+		const SimdFloat inverseWRow = SimdSet(triangle.inverseW[1] * pixelY + triangle.inverseW[2]);
+		SimdFloat colorRow[3];
+		for (int channel = 0; channel < 3; channel++)
+		{
+			colorRow[channel] = SimdSet(triangle.colorOverW[channel][1] * pixelY + triangle.colorOverW[channel][2]);
+		}
+
+		float* depthPixels = &target.depth[(size_t)y * target.stride];
+		uint32_t* colorPixels = &target.color[(size_t)y * target.stride];
+
+		// Groups start 4 pixel aligned, tiles are a multiple of 4 wide so a group never crosses into another tile.
+		// Triangles are convex, so once the row has been entered the first uncovered group ends it.
+		bool rowEntered = false;
+		for (int32_t x = minX & ~3; x <= maxX; x += 4)
+		{
+			const SimdFloat pixelX = SimdAdd(SimdSet((float)x), laneOffsets);
+
+			// Coverage, with the top-left rule deciding pixel centers exactly on an edge
+			int coverage = 0xF;
+			for (int i = 0; i < 3 && coverage; i++)
+			{
+				const SimdFloat edge = SimdAdd(SimdMul(edgeA[i], pixelX), edgeRow[i]);
+				coverage &= SimdMoveMask(triangle.edgeTopLeft[i] ? SimdGreaterEqual(edge, zero) : SimdGreater(edge, zero));
+			}
+			if (x < minX)
+				coverage &= 0xF << (minX - x);
+			if (x + 3 > maxX)
+				coverage &= 0xF >> (x + 3 - maxX);
+			if (!coverage)
+			{
+				if (rowEntered)
+					break;
+				continue;
+			}
+			rowEntered = true;
+			pixelsCovered += laneCount[coverage];
+
+			// LESS depth test
+			const SimdFloat depth = SimdAdd(SimdMul(depthA, pixelX), depthRow);
+			const SimdFloat previousDepth = SimdLoad(depthPixels + x);
+			coverage &= SimdMoveMask(SimdLess(depth, previousDepth));
+			if (!coverage)
+				continue;
+
+			SimdStore(depthPixels + x, SimdSelect(SimdMaskFromBits(coverage), depth, previousDepth));
+
+			// Pixel shader, interpolated color with alpha 1
+			const SimdFloat w = SimdDiv(one, SimdAdd(SimdMul(inverseWA, pixelX), inverseWRow));
+			float color[3][4];
+			for (int channel = 0; channel < 3; channel++)
+			{
+				const SimdFloat value = SimdMul(SimdAdd(SimdMul(colorA[channel], pixelX), colorRow[channel]), w);
+				SimdStore(color[channel], SimdMin(SimdMax(value, zero), one));
+			}
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (coverage & (1 << lane))
+				{
+					colorPixels[x + lane] =
+						(uint32_t)(color[0][lane] * 255.0f + 0.5f) |
+						(uint32_t)(color[1][lane] * 255.0f + 0.5f) << 8 |
+						(uint32_t)(color[2][lane] * 255.0f + 0.5f) << 16 |
+						0xFF000000u;
+					pixelsWritten++;
+				}
+			}
+		}
+	}
+
+	stats.pixelsCovered += pixelsCovered;
+	stats.pixelsWritten += pixelsWritten;
+}
+
+
+SoftwareRasterizerStats SoftwareDrawInstances(SoftwareRasterizer& rasterizer, SoftwareRenderTarget& target, const SoftwareMesh& mesh, const Float4x4& viewProjection, const vector<Float4x4>& models)
+{
+	const uint32_t binCount = rasterizer.binCount;
+	const int32_t tilesX = (target.width + softwareTileSize - 1) / softwareTileSize;
+	const int32_t tilesY = (target.height + softwareTileSize - 1) / softwareTileSize;
+	const size_t tileCount = (size_t)tilesX * tilesY;
+
+
+	// Reset the bins, keeping their memory from the previous draw
+	{
+		rasterizer.tilesX = tilesX;
+		rasterizer.tilesY = tilesY;
+		for (uint32_t bin = 0; bin < binCount; bin++)
+		{
+			rasterizer.triangles[bin].clear();
+			rasterizer.tileTriangles[bin].resize(tileCount);
+			for (vector<uint32_t>& tile : rasterizer.tileTriangles[bin])
+			{
+				tile.clear();
+			}
+			rasterizer.binStats[bin] = {};
+		}
+		rasterizer.tileStats.assign(tileCount, {});
+	}
+
+
+	// Front end, one job per bin transforms and bins a contiguous range of instances. Rasterizing the bins in order
+	// then keeps the API submission order, so the image does not depend on the number of threads.
+	{
+		JobCounter binned;
+		JobParallelFor(binned, binCount, 1, [&](size_t begin, size_t end) {
+			for (size_t bin = begin; bin < end; bin++)
+			{
+				const size_t first = models.size() * bin / binCount;
+				const size_t last = models.size() * (bin + 1) / binCount;
+				SoftwareTransformInstances(rasterizer, (uint32_t)bin, target, mesh, viewProjection, models.data() + first, last - first);
+			}
+		});
+		JobWait(binned);
+	}
+
+
+	// Back end, one job per tile. Each tile is rasterized by a single job so no pixel is shared between threads.
+	{
+		JobCounter rasterized;
+		JobParallelFor(rasterized, tileCount, 1, [&](size_t begin, size_t end) {
+			for (size_t tile = begin; tile < end; tile++)
+			{
+				const int32_t tileX = (int32_t)(tile % tilesX) * softwareTileSize;
+				const int32_t tileY = (int32_t)(tile / tilesX) * softwareTileSize;
+
+				for (uint32_t bin = 0; bin < binCount; bin++)
+				{
+					const vector<SoftwareTriangle>& triangles = rasterizer.triangles[bin];
+					for (uint32_t triangleIndex : rasterizer.tileTriangles[bin][tile])
+					{
+						SoftwareRasterizeTriangle(triangles[triangleIndex], tileX, tileY, target, rasterizer.tileStats[tile]);
+					}
+				}
+			}
+		});
+		JobWait(rasterized);
+	}
+
+
+	SoftwareRasterizerStats total;
+	for (const SoftwareRasterizerStats& stats : rasterizer.binStats)
+	{
+		total.trianglesSubmitted += stats.trianglesSubmitted;
+		total.trianglesRasterized += stats.trianglesRasterized;
+	}
+	for (const SoftwareRasterizerStats& stats : rasterizer.tileStats)
+	{
+		total.pixelsCovered += stats.pixelsCovered;
+		total.pixelsWritten += stats.pixelsWritten;
+	}
+	return total;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Core/VectorMath.h"
+
+// CPU implementation of exactly what the cube pipeline does on the GPU: transform by Model and ViewProjection,
+// clip, cull counter-clockwise triangles, LESS depth test and perspective correct vertex color interpolation
+// into an RGBA8 target. Triangles are binned into screen tiles and the tiles are rasterized in parallel on the job
+// system with 4 wide SIMD edge functions, so it can render large instance counts headless and without a GPU.
+
+constexpr int32_t softwareTileSize = 64;
+
+// In-memory replacement for a swapchain image and its depth buffer
+struct SoftwareRenderTarget {
+	int32_t width = 0;
+	int32_t height = 0;
+	int32_t stride = 0;          // Pixels per row, width rounded up to a multiple of 4
+	std::vector<uint32_t> color; // R8G8B8A8, red in the lowest byte
+	std::vector<float> depth;
+};
+
+// Position followed by color for every vertex, the same layout as cubeVertices
+struct SoftwareMesh {
+	const float* vertices;
+	uint32_t vertexCount;
+	const uint16_t* indices;
+	uint32_t indexCount;
+};
+
+struct SoftwareRasterizerStats {
+	uint64_t trianglesSubmitted = 0;
+	uint64_t trianglesRasterized = 0; // After clipping and culling, a clipped triangle may count more than once
+	uint64_t pixelsCovered = 0;       // Pixels inside of a triangle, each one is depth tested
+	uint64_t pixelsWritten = 0;       // Pixels that passed the depth test
+};
+
+// Screen space triangle after clipping and projection, with the plane equations rasterization needs
+struct SoftwareTriangle {
+	float edgeA[3], edgeB[3], edgeC[3];
+	bool edgeTopLeft[3];
+	float depth[3];                   // Plane a*x + b*y + c of the depth, linear in screen space
+	float inverseW[3];
+	float colorOverW[3][3];
+	int32_t minX, minY, maxX, maxY;   // Pixel bounds, inclusive
+};
+
+// Binning state reused between draws. Instances are split into bins, each transformed and binned by its own job
+// so no locks are needed, and tiles are rasterized by the job system in parallel.
+struct SoftwareRasterizer {
+	uint32_t binCount = 0;
+	int32_t tilesX = 0;
+	int32_t tilesY = 0;
+	std::vector<std::vector<SoftwareTriangle>> triangles;           // [bin]
+	std::vector<std::vector<std::vector<uint32_t>>> tileTriangles;  // [bin][tile]
+	std::vector<SoftwareRasterizerStats> binStats;                  // [bin]
+	std::vector<SoftwareRasterizerStats> tileStats;                 // [tile]
+};
+
+
+// Needs an initialized job system
+void SoftwareRasterizerInitialize(SoftwareRasterizer& rasterizer);
+
+void SoftwareCreateRenderTarget(SoftwareRenderTarget& target, int32_t width, int32_t height);
+void SoftwareClear(SoftwareRenderTarget& target, const float color[4], float depth);
+
+// Draw the mesh once for every model matrix, same as RenderBackend::RenderView does on the GPU
+SoftwareRasterizerStats SoftwareDrawInstances(SoftwareRasterizer& rasterizer, SoftwareRenderTarget& target, const SoftwareMesh& mesh, const Float4x4& viewProjection, const std::vector<Float4x4>& models);
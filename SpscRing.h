@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Fixed size lock-free ring buffer for exactly one producer thread and one consumer thread.
+// Neither side ever blocks: Push fails when the ring is full and Pop fails when it is empty.
+template <typename T, size_t Capacity>
+struct SpscRing {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	// Producer thread only
+	bool Push(const T& item)
+	{
+		const size_t write = head.load(std::memory_order_relaxed);
+		if (write - tail.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+
+		items[write & (Capacity - 1)] = item;
+		head.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer thread only
+	bool Pop(T& item)
+	{
+		const size_t read = tail.load(std::memory_order_relaxed);
+		if (head.load(std::memory_order_acquire) == read)
+		{
+			return false;
+		}
+
+		item = items[read & (Capacity - 1)];
+		tail.store(read + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer thread only, drops everything pushed so far
+	void Clear()
+	{
+		tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	// Producer and consumer indices on their own cache lines so the two threads do not invalidate each other's
+	alignas(64) std::atomic<size_t> head{ 0 };
+	alignas(64) std::atomic<size_t> tail{ 0 };
+	alignas(64) T items[Capacity];
+};
@@ -0,0 +1,278 @@
+#include "Telemetry.h"
+
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+TelemetryBlock* telemetryBlock = nullptr;
+#ifdef _WIN32
+HANDLE telemetryMapping = nullptr;
+#endif
+
+
+////////////////////////////////////////////////
+// Shared memory
+////////////////////////////////////////////////
+
+bool TelemetryCreate()
+{
+	// Map the named block, it is zero filled when new
+	void* memory = nullptr;
+	{
+#ifdef _WIN32
+		telemetryMapping = CreateFileMappingFromApp(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, sizeof(TelemetryBlock), telemetryDefaultName);
+		if (telemetryMapping == nullptr)
+		{
+			return false;
+		}
+
+		memory = MapViewOfFileFromApp(telemetryMapping, FILE_MAP_WRITE, 0, sizeof(TelemetryBlock));
+		if (memory == nullptr)
+		{
+			CloseHandle(telemetryMapping);
+			telemetryMapping = nullptr;
+			return false;
+		}
+#else
+		const int file = shm_open(telemetryDefaultName, O_CREAT | O_RDWR, 0644);
+		if (file < 0)
+		{
+			return false;
+		}
+
+		if (ftruncate(file, sizeof(TelemetryBlock)) == 0)
+		{
+			memory = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		}
+		close(file);
+
+		if (memory == nullptr || memory == MAP_FAILED)
+		{
+			shm_unlink(telemetryDefaultName);
+			return false;
+		}
+#endif
+	}
+
+
+	// Start from a clean block in case a previous run left one behind, readers ignore it until magic is set again
+	{
+		telemetryBlock = (TelemetryBlock*)memory;
+		telemetryBlock->magic.store(0, memory_order_relaxed);
+		atomic_thread_fence(memory_order_release);
+
+		memset((char*)telemetryBlock + sizeof(telemetryBlock->magic), 0, sizeof(TelemetryBlock) - sizeof(telemetryBlock->magic));
+		telemetryBlock->version = telemetryVersion;
+		telemetryBlock->size = sizeof(TelemetryBlock);
+		telemetryBlock->frameRecordCapacity = telemetryFrameRecordCapacity;
+		telemetryBlock->magic.store(telemetryMagic, memory_order_release);
+	}
+
+	return true;
+}
+
+
+void TelemetryDestroy()
+{
+	if (telemetryBlock == nullptr)
+	{
+		return;
+	}
+
+	telemetryBlock->magic.store(0, memory_order_release);
+
+#ifdef _WIN32
+	UnmapViewOfFile(telemetryBlock);
+	CloseHandle(telemetryMapping);
+	telemetryMapping = nullptr;
+#else
+	munmap(telemetryBlock, sizeof(TelemetryBlock));
+	shm_unlink(telemetryDefaultName);
+#endif
+	telemetryBlock = nullptr;
+}
+
+
+#ifdef _WIN32
+const TelemetryBlock* TelemetryOpen(const wchar_t* name)
+{
+	HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, name);
+	if (mapping == nullptr)
+	{
+		return nullptr;
+	}
+
+	// The view keeps the mapping alive on its own
+	const void* memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(TelemetryBlock));
+	CloseHandle(mapping);
+	return (const TelemetryBlock*)memory;
+}
+#else
+const TelemetryBlock* TelemetryOpen(const char* name)
+{
+	const int file = shm_open(name, O_RDONLY, 0);
+	if (file < 0)
+	{
+		return nullptr;
+	}
+
+	// A block that is still being created may be shorter than the layout
+	void* memory = MAP_FAILED;
+	if (lseek(file, 0, SEEK_END) >= (off_t)sizeof(TelemetryBlock))
+	{
+		memory = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED, file, 0);
+	}
+	close(file);
+
+	return memory == MAP_FAILED ? nullptr : (const TelemetryBlock*)memory;
+}
+#endif
+
+
+void TelemetryClose(const TelemetryBlock* block)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(block);
+#else
+	munmap((void*)block, sizeof(TelemetryBlock));
+#endif
+}
+
+
+////////////////////////////////////////////////
+// Histograms
+////////////////////////////////////////////////
+
+void TelemetryHistogramAdd(TelemetryLatencyHistogram& histogram, double milliseconds)
+{
+	const double bucket = milliseconds / telemetryLatencyBucketMilliseconds;
+	const uint32_t index = bucket <= 0.0 ? 0 : bucket >= telemetryLatencyBucketCount - 1 ? telemetryLatencyBucketCount - 1 : (uint32_t)bucket;
+
+	histogram.buckets[index]++;
+	histogram.count++;
+	histogram.sumMilliseconds += milliseconds;
+	histogram.maxMilliseconds = histogram.count == 1 || milliseconds > histogram.maxMilliseconds ? milliseconds : histogram.maxMilliseconds;
+}
+
+
+double TelemetryHistogramPercentile(const TelemetryLatencyHistogram& histogram, double fraction)
+{
+	// Smallest bucket where the counts up to and including it reach the fraction of all counts
+	const double target = fraction * (double)histogram.count;
+	uint64_t counted = 0;
+	for (uint32_t i = 0; i < telemetryLatencyBucketCount; i++)
+	{
+		counted += histogram.buckets[i];
+		if (counted > 0 && (double)counted >= target)
+		{
+			const double upperEdge = (i + 1) * telemetryLatencyBucketMilliseconds;
+			return upperEdge < histogram.maxMilliseconds ? upperEdge : histogram.maxMilliseconds;
+		}
+	}
+	return histogram.maxMilliseconds;
+}
+
+
+////////////////////////////////////////////////
+// Seqlock
+////////////////////////////////////////////////
+
+TelemetryCounters* TelemetryBeginWriteCounters()
+{
+	if (telemetryBlock == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Odd while the counters change, single writer so the sequence number needs no read-modify-write
+	const uint32_t sequence = telemetryBlock->countersSequence.load(memory_order_relaxed);
+	telemetryBlock->countersSequence.store(sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	return &telemetryBlock->counters;
+}
+
+
+void TelemetryEndWriteCounters()
+{
+	const uint32_t sequence = telemetryBlock->countersSequence.load(memory_order_relaxed);
+	telemetryBlock->countersSequence.store(sequence + 1, memory_order_release);
+}
+
+
+void TelemetryWriteFrameRecord(const TelemetryFrameRecord& record)
+{
+	if (telemetryBlock == nullptr)
+	{
+		return;
+	}
+
+	const uint64_t index = telemetryBlock->frameRecordCount.load(memory_order_relaxed);
+	TelemetryFrameRecordSlot& slot = telemetryBlock->frameRecords[index % telemetryFrameRecordCapacity];
+
+	const uint32_t sequence = slot.sequence.load(memory_order_relaxed);
+	slot.sequence.store(sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	slot.record = record;
+	slot.record.frameIndex = index;
+
+	slot.sequence.store(sequence + 2, memory_order_release);
+	telemetryBlock->frameRecordCount.store(index + 1, memory_order_release);
+}
+
+
+void TelemetryReadCounters(const TelemetryBlock& block, TelemetryCounters& counters)
+{
+	for (;;)
+	{
+		const uint32_t before = block.countersSequence.load(memory_order_acquire);
+		if ((before & 1) == 0)
+		{
+			memcpy(&counters, (const void*)&block.counters, sizeof(counters));
+			atomic_thread_fence(memory_order_acquire);
+			if (block.countersSequence.load(memory_order_relaxed) == before)
+			{
+				return;
+			}
+		}
+		this_thread::yield();
+	}
+}
+
+
+bool TelemetryReadFrameRecord(const TelemetryBlock& block, uint64_t index, TelemetryFrameRecord& record)
+{
+	const uint64_t count = block.frameRecordCount.load(memory_order_acquire);
+	if (index >= count || count - index > telemetryFrameRecordCapacity)
+	{
+		return false;
+	}
+
+	const TelemetryFrameRecordSlot& slot = block.frameRecords[index % telemetryFrameRecordCapacity];
+	for (;;)
+	{
+		const uint32_t before = slot.sequence.load(memory_order_acquire);
+		if ((before & 1) == 0)
+		{
+			memcpy(&record, (const void*)&slot.record, sizeof(record));
+			atomic_thread_fence(memory_order_acquire);
+			if (slot.sequence.load(memory_order_relaxed) == before)
+			{
+				// The writer may have lapped the reader and reused the slot for a newer record
+				return record.frameIndex == index;
+			}
+		}
+		this_thread::yield();
+	}
+}
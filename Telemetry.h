@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Live telemetry for external monitors: a fixed layout block in named shared memory with the app's counters and a
+// ring of the most recent frame records. The app is the only writer and never waits for readers. Every write is
+// guarded by a sequence number (seqlock) that is odd while the write is in progress, readers copy the data and retry
+// when the sequence number was odd or changed meanwhile.
+//
+// Any change of the layout, including fields added to TelemetryCounters or TelemetryFrameRecord, needs a new
+// telemetryVersion: the frame records follow the counters, so growing either one moves everything after it. Readers
+// reject a block whose version or size is not their own (TelemetryIsValid in TelemetryReader.cpp).
+
+constexpr uint32_t telemetryMagic = 0x5452584F; // "OXRT"
+constexpr uint32_t telemetryVersion = 5;
+constexpr uint32_t telemetryFrameRecordCapacity = 512;
+
+// Latency histograms have fixed width buckets, bucket i counts latencies from i to i + 1 bucket widths and the last
+// bucket everything above
+constexpr uint32_t telemetryLatencyBucketCount = 64;
+constexpr double telemetryLatencyBucketMilliseconds = 2.0;
+
+// Modes the app ran in while the latency histograms were collected, TelemetryCounters::latencyModes
+constexpr uint32_t telemetryModeInputThread = 1 << 0;
+constexpr uint32_t telemetryModeJobThreads = 1 << 1;
+constexpr uint32_t telemetryModeOcclusionCulling = 1 << 2;
+constexpr uint32_t telemetryModeHalfRate = 1 << 3;
+constexpr uint32_t telemetryModeDepthLayer = 1 << 4;
+
+#ifdef _WIN32
+constexpr const wchar_t* telemetryDefaultName = L"Local\\OpenXRExampleTelemetry";
+#else
+constexpr const char* telemetryDefaultName = "/OpenXRExampleTelemetry";
+#endif
+
+struct TelemetryLatencyHistogram {
+	uint64_t count;
+	double sumMilliseconds;
+	double maxMilliseconds;
+	uint32_t buckets[telemetryLatencyBucketCount];
+};
+
+struct TelemetryCounters {
+	// Frame loop, updated by OpenXRRenderFrame
+	uint64_t frameCount;              // Frames ended with xrEndFrame
+	uint64_t missedFrameCount;        // Display periods that passed without a frame of ours, from gaps in predicted display times
+	double frameMilliseconds;         // CPU time of the last frame, from xrWaitFrame returning to xrEndFrame returning
+	double displayPeriodMilliseconds;
+	uint32_t cubeCount;
+	uint32_t drawCallCount;           // Of the last frame, all views together
+	uint32_t sessionState;            // XrSessionState
+	uint32_t viewCount;
+
+	// Input, updated by OpenXRPollActions
+	uint64_t placedCubeCount;
+	double inputLatencyMilliseconds;  // Of the last placement, from select going down until the cube was in the scene. 0 if unknown
+
+	// Startup, updated by the init path
+	double startupMilliseconds;       // Until every startup task finished
+	double firstFrameMilliseconds;    // Until the first frame with content was submitted
+
+	// Occlusion culling of the last frame, all views together. Added in version 2
+	uint32_t occludedCount;           // Cubes in a view frustum that were left out because occluders hide them
+	uint32_t occluderCount;
+	double occlusionMilliseconds;     // CPU time of occluder rasterization and occlusion tests on all job threads
+
+	// Reduced rate rendering, frames that rendered their layer and frames that submitted the previous one again. Added in version 3
+	uint64_t renderedFrameCount;
+	uint64_t reprojectedFrameCount;
+
+	// Session recovery. Added in version 4
+	uint32_t sessionLossCount;
+	uint32_t reserved;
+	double sessionRecoveryMilliseconds; // Of the last loss, until a frame with content was submitted again
+
+	// Latency histograms, started over whenever latencyModes changes. Added in version 5
+	uint32_t latencyModes;                           // telemetryMode* flags
+	uint32_t reserved2;
+	TelemetryLatencyHistogram placementLatency;      // Select press until the predicted display time of the first frame showing the new cube
+	TelemetryLatencyHistogram handMotionToPhoton;    // Hand poses located until the predicted display time of frames showing hand cubes
+};
+
+struct TelemetryFrameRecord {
+	uint64_t frameIndex;              // Index of the record, set by TelemetryWriteFrameRecord
+	int64_t predictedDisplayTime;     // XrTime
+	float frameMilliseconds;
+	float waitFrameMilliseconds;      // Time blocked in xrWaitFrame
+	uint32_t cubeCount;
+	uint32_t drawCallCount;
+	uint32_t missedFrameCount;        // Display periods missed right before this frame
+	uint32_t rendered;                // 1 if the frame had a layer, 0 if it was ended empty
+	uint32_t occludedCount;           // Added in version 2
+	uint32_t occluderCount;
+	float occlusionMilliseconds;
+	uint32_t reprojected;             // 1 if the frame submitted the previous frame's layer again instead of rendering. Added in version 3
+};
+
+struct TelemetryFrameRecordSlot {
+	std::atomic<uint32_t> sequence;
+	uint32_t reserved;
+	TelemetryFrameRecord record;
+};
+
+struct TelemetryBlock {
+	// Identification, valid once magic is set
+	std::atomic<uint32_t> magic;
+	uint32_t version;
+	uint32_t size;                    // sizeof(TelemetryBlock) of the writer
+	uint32_t frameRecordCapacity;
+
+	std::atomic<uint32_t> countersSequence;
+	uint32_t reserved;
+	TelemetryCounters counters;
+
+	// Records written so far, record n is in frameRecords[n % frameRecordCapacity] until it is overwritten
+	std::atomic<uint64_t> frameRecordCount;
+	TelemetryFrameRecordSlot frameRecords[telemetryFrameRecordCapacity];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free, "telemetry is shared between processes");
+
+
+// Writer. Create the shared block of the app, writes do nothing until it exists or if it could not be created
+bool TelemetryCreate();
+void TelemetryDestroy();
+
+// Call update with the counters to change them in place, a template so per-frame updates capturing a lot of state do
+// not allocate
+template <typename Update>
+void TelemetryWriteCounters(const Update& update);
+void TelemetryWriteFrameRecord(const TelemetryFrameRecord& record);
+
+
+// Readers. Open the block of a running app, nullptr if there is none
+#ifdef _WIN32
+const TelemetryBlock* TelemetryOpen(const wchar_t* name);
+#else
+const TelemetryBlock* TelemetryOpen(const char* name);
+#endif
+void TelemetryClose(const TelemetryBlock* block);
+
+// Histogram helpers, add is for the writer inside TelemetryWriteCounters. The percentile is the upper edge of the bucket
+// it falls into, or the maximum when that is smaller
+void TelemetryHistogramAdd(TelemetryLatencyHistogram& histogram, double milliseconds);
+double TelemetryHistogramPercentile(const TelemetryLatencyHistogram& histogram, double fraction);
+
+// Consistent copy of the counters
+void TelemetryReadCounters(const TelemetryBlock& block, TelemetryCounters& counters);
+
+// Consistent copy of record index, false if it was not written yet or was already overwritten
+bool TelemetryReadFrameRecord(const TelemetryBlock& block, uint64_t index, TelemetryFrameRecord& record);
+
+
+// Begin and end of a seqlock write of the counters, use TelemetryWriteCounters. Begin returns nullptr when there is no
+// block, end is only called when begin did not
+TelemetryCounters* TelemetryBeginWriteCounters();
+void TelemetryEndWriteCounters();
+
+template <typename Update>
+void TelemetryWriteCounters(const Update& update)
+{
+	TelemetryCounters* counters = TelemetryBeginWriteCounters();
+	if (counters == nullptr)
+	{
+		return;
+	}
+
+	update(*counters);
+
+	TelemetryEndWriteCounters();
+}
@@ -0,0 +1,248 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <cwchar>
+#include <windows.h>
+#include <securityappcontainer.h>
+#include <userenv.h>
+#endif
+
+#include "Telemetry.h"
+
+using namespace std;
+
+// Prints the live telemetry of a running OpenXRExample, waiting for the app to start if it is not running yet.
+// Without --frames it prints the counters every interval, with --frames it logs every frame record as a CSV line and
+// with --histograms it prints the latency histograms as CSV every interval, to compare runs in different modes.
+// --name opens a block other than the default one, --package the block of the packaged app with that package family
+// name in its AppContainer's named object namespace (Windows only).
+//
+//   TelemetryReader [--interval MS] [--frames | --histograms] [--count N] [--name NAME | --package FAMILYNAME]
+
+
+// Active modes as a + separated list
+const char* TelemetryModesName(uint32_t modes, char* name, size_t size)
+{
+	const struct { uint32_t flag; const char* name; } modeNames[] =
+	{
+		{ telemetryModeInputThread, "inputthread" },
+		{ telemetryModeJobThreads, "jobthreads" },
+		{ telemetryModeOcclusionCulling, "occlusion" },
+		{ telemetryModeHalfRate, "halfrate" },
+		{ telemetryModeDepthLayer, "depthlayer" },
+	};
+
+	snprintf(name, size, "%s", modes == 0 ? "none" : "");
+	for (const auto& modeName : modeNames)
+	{
+		if ((modes & modeName.flag) != 0)
+		{
+			const size_t length = strlen(name);
+			snprintf(name + length, size - length, "%s%s", length > 0 ? "+" : "", modeName.name);
+		}
+	}
+	return name;
+}
+
+
+void TelemetryPrintCounters(const TelemetryCounters& counters)
+{
+	printf("frames %llu missed %llu rendered %llu reprojected %llu | frame %6.2f ms period %6.2f ms | cubes %u draws %u views %u | occluded %u by %u in %5.2f ms | placed %llu latency %6.2f ms | state %u | startup %.1f ms first frame %.1f ms | session losses %u recovery %.1f ms\n",
+		(unsigned long long)counters.frameCount, (unsigned long long)counters.missedFrameCount,
+		(unsigned long long)counters.renderedFrameCount, (unsigned long long)counters.reprojectedFrameCount,
+		counters.frameMilliseconds, counters.displayPeriodMilliseconds,
+		counters.cubeCount, counters.drawCallCount, counters.viewCount,
+		counters.occludedCount, counters.occluderCount, counters.occlusionMilliseconds,
+		(unsigned long long)counters.placedCubeCount, counters.inputLatencyMilliseconds,
+		counters.sessionState, counters.startupMilliseconds, counters.firstFrameMilliseconds,
+		counters.sessionLossCount, counters.sessionRecoveryMilliseconds);
+
+	char modes[128];
+	printf("  latency in %s | placement p50 %5.1f p99 %5.1f max %5.1f ms of %llu | hand motion to photon p50 %5.1f p99 %5.1f max %5.1f ms of %llu\n",
+		TelemetryModesName(counters.latencyModes, modes, sizeof(modes)),
+		TelemetryHistogramPercentile(counters.placementLatency, 0.5), TelemetryHistogramPercentile(counters.placementLatency, 0.99),
+		counters.placementLatency.maxMilliseconds, (unsigned long long)counters.placementLatency.count,
+		TelemetryHistogramPercentile(counters.handMotionToPhoton, 0.5), TelemetryHistogramPercentile(counters.handMotionToPhoton, 0.99),
+		counters.handMotionToPhoton.maxMilliseconds, (unsigned long long)counters.handMotionToPhoton.count);
+}
+
+
+void TelemetryPrintHistograms(const TelemetryCounters& counters)
+{
+	char modes[128];
+	TelemetryModesName(counters.latencyModes, modes, sizeof(modes));
+
+	printf("modes,bucketMs,placement,handMotionToPhoton\n");
+	for (uint32_t i = 0; i < telemetryLatencyBucketCount; i++)
+	{
+		printf("%s,%.0f,%u,%u\n", modes, i * telemetryLatencyBucketMilliseconds, counters.placementLatency.buckets[i], counters.handMotionToPhoton.buckets[i]);
+	}
+}
+
+
+void TelemetryPrintFrameRecord(const TelemetryFrameRecord& record)
+{
+	printf("%llu,%lld,%.3f,%.3f,%u,%u,%u,%u,%u,%u,%.3f,%u\n",
+		(unsigned long long)record.frameIndex, (long long)record.predictedDisplayTime,
+		record.frameMilliseconds, record.waitFrameMilliseconds,
+		record.cubeCount, record.drawCallCount, record.missedFrameCount, record.rendered,
+		record.occludedCount, record.occluderCount, record.occlusionMilliseconds, record.reprojected);
+}
+
+
+#ifdef _WIN32
+wstring TelemetryWideString(const char* text)
+{
+	wchar_t wide[512] = {};
+	MultiByteToWideChar(CP_UTF8, 0, text, -1, wide, (int)(sizeof(wide) / sizeof(wide[0])) - 1);
+	return wide;
+}
+
+
+// Name a reader outside the package opens the block of a packaged app with, the block name in the package's
+// AppContainer namespace: AppContainerNamedObjects\<AppContainer SID>\OpenXRExampleTelemetry. Empty if there is none
+wstring TelemetryPackageBlockName(const char* packageFamilyName)
+{
+	PSID appContainerSid = nullptr;
+	if (FAILED(DeriveAppContainerSidFromAppContainerName(TelemetryWideString(packageFamilyName).c_str(), &appContainerSid)))
+	{
+		return L"";
+	}
+
+	wchar_t path[MAX_PATH] = {};
+	ULONG pathLength = 0;
+	const BOOL found = GetAppContainerNamedObjectPath(nullptr, appContainerSid, MAX_PATH, path, &pathLength);
+	FreeSid(appContainerSid);
+	if (!found)
+	{
+		return L"";
+	}
+
+	// Followed by the default name without its Local prefix
+	return wstring(path) + wcschr(telemetryDefaultName, L'\\');
+}
+#endif
+
+
+bool TelemetryIsValid(const TelemetryBlock& block)
+{
+	return block.magic.load(memory_order_acquire) == telemetryMagic && block.version == telemetryVersion && block.size == sizeof(TelemetryBlock);
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t intervalMilliseconds = 500;
+	bool logFrames = false;
+	bool printHistograms = false;
+	uint64_t count = 0; // Lines to print before exiting, 0 runs until interrupted
+#ifdef _WIN32
+	wstring name = telemetryDefaultName;
+#else
+	string name = telemetryDefaultName;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (!strcmp(argv[i], "--interval") && hasValue) intervalMilliseconds = (uint32_t)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--frames")) logFrames = true;
+		else if (!strcmp(argv[i], "--histograms")) printHistograms = true;
+		else if (!strcmp(argv[i], "--count") && hasValue) count = (uint64_t)atoll(argv[++i]);
+#ifdef _WIN32
+		else if (!strcmp(argv[i], "--name") && hasValue) name = TelemetryWideString(argv[++i]);
+		else if (!strcmp(argv[i], "--package") && hasValue)
+		{
+			name = TelemetryPackageBlockName(argv[++i]);
+			if (name.empty())
+			{
+				printf("No AppContainer for package family %s\n", argv[i]);
+				return 1;
+			}
+		}
+#else
+		else if (!strcmp(argv[i], "--name") && hasValue) name = argv[++i];
+#endif
+		else
+		{
+			printf("Usage: %s [--interval MS] [--frames | --histograms] [--count N] [--name NAME | --package FAMILYNAME]\n", argv[0]);
+			return 1;
+		}
+	}
+
+
+	uint64_t printed = 0;
+	while (count == 0 || printed < count)
+	{
+		// Wait for the app, and reopen the block when the app restarted
+		const TelemetryBlock* block = TelemetryOpen(name.c_str());
+		if (block == nullptr || !TelemetryIsValid(*block))
+		{
+			if (block != nullptr)
+			{
+				TelemetryClose(block);
+			}
+			this_thread::sleep_for(chrono::seconds(1));
+			continue;
+		}
+
+
+		// Frame records from the oldest one still in the ring
+		uint64_t nextRecord = 0;
+		if (logFrames)
+		{
+			printf("frame,predictedDisplayTime,frameMs,waitFrameMs,cubes,drawCalls,missedFrames,rendered,occluded,occluders,occlusionMs,reprojected\n");
+			const uint64_t recordCount = block->frameRecordCount.load(memory_order_acquire);
+			nextRecord = recordCount > telemetryFrameRecordCapacity ? recordCount - telemetryFrameRecordCapacity : 0;
+		}
+
+		while (TelemetryIsValid(*block) && (count == 0 || printed < count))
+		{
+			if (logFrames)
+			{
+				// Records the reader fell too far behind for are skipped, the count starts over when the app restarted
+				const uint64_t recordCount = block->frameRecordCount.load(memory_order_acquire);
+				if (recordCount < nextRecord)
+				{
+					nextRecord = 0;
+				}
+				for (; nextRecord < recordCount && (count == 0 || printed < count); nextRecord++)
+				{
+					TelemetryFrameRecord record;
+					if (TelemetryReadFrameRecord(*block, nextRecord, record))
+					{
+						TelemetryPrintFrameRecord(record);
+						printed++;
+					}
+				}
+				fflush(stdout);
+				this_thread::sleep_for(chrono::milliseconds(intervalMilliseconds / 10 + 1));
+			}
+			else
+			{
+				TelemetryCounters counters;
+				TelemetryReadCounters(*block, counters);
+				if (printHistograms)
+				{
+					TelemetryPrintHistograms(counters);
+				}
+				else
+				{
+					TelemetryPrintCounters(counters);
+				}
+				fflush(stdout);
+				printed++;
+				this_thread::sleep_for(chrono::milliseconds(intervalMilliseconds));
+			}
+		}
+
+		TelemetryClose(block);
+	}
+
+	return 0;
+}
@@ -0,0 +1,145 @@
+#include <cmath>
+#include <cstdio>
+
+#include "Core/VectorMath.h"
+#include "Core/FramePacing.h"
+
+using namespace std;
+
+// Checks the pure Core logic behind reduced rate rendering: the motion tolerance of poses and the frame pacing
+// sequence. Returns non-zero when a check failed.
+//
+//   CoreTests
+
+
+uint32_t testFailureCount = 0;
+
+#define TEST_CHECK(condition) \
+	do { if (!(condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); testFailureCount++; } } while (0)
+
+
+////////////////////////////////////////////////
+// Pose tolerance
+////////////////////////////////////////////////
+
+// Pose rotated by angle radians around the axis (x, y, z), which is unit length
+Pose TestPose(float x, float y, float z, float angle, const Float3& position)
+{
+	const float s = sinf(angle * 0.5f);
+	return { { x * s, y * s, z * s, cosf(angle * 0.5f) }, position };
+}
+
+
+void TestPoseWithinTolerance()
+{
+	// The app's thresholds at 60 Hz
+	const float seconds = 1.0f / 60.0f;
+	const float maxDistance = 0.02f * seconds;
+	const float maxAngle = 0.1f * seconds;
+	const Float3 position = { 0.1f, 1.6f, -0.3f };
+	const Pose a = TestPose(0, 1, 0, 0.7f, position);
+
+	TEST_CHECK(PoseWithinTolerance(a, a, maxDistance, maxAngle));
+
+	// Translation
+	TEST_CHECK(PoseWithinTolerance(a, TestPose(0, 1, 0, 0.7f, { position.x + maxDistance * 0.9f, position.y, position.z }), maxDistance, maxAngle));
+	TEST_CHECK(!PoseWithinTolerance(a, TestPose(0, 1, 0, 0.7f, { position.x, position.y - maxDistance * 1.1f, position.z }), maxDistance, maxAngle));
+
+	// Rotation just inside and just outside of the threshold, around the same and around other axes
+	TEST_CHECK(PoseWithinTolerance(a, TestPose(0, 1, 0, 0.7f + maxAngle * 0.9f, position), maxDistance, maxAngle));
+	TEST_CHECK(!PoseWithinTolerance(a, TestPose(0, 1, 0, 0.7f + maxAngle * 1.1f, position), maxDistance, maxAngle));
+	TEST_CHECK(PoseWithinTolerance(poseIdentity, TestPose(1, 0, 0, maxAngle * 0.9f, { 0, 0, 0 }), maxDistance, maxAngle));
+	TEST_CHECK(!PoseWithinTolerance(poseIdentity, TestPose(1, 0, 0, maxAngle * 1.1f, { 0, 0, 0 }), maxDistance, maxAngle));
+	TEST_CHECK(!PoseWithinTolerance(poseIdentity, TestPose(0, 0, 1, -maxAngle * 1.1f, { 0, 0, 0 }), maxDistance, maxAngle));
+
+	// q and -q are the same rotation
+	{
+		const Pose negated = { { -a.orientation.x, -a.orientation.y, -a.orientation.z, -a.orientation.w }, a.position };
+		TEST_CHECK(PoseWithinTolerance(a, negated, maxDistance, maxAngle));
+	}
+
+	// Quaternions a few ulps off unit length, as runtimes return them, are still the same rotation. Their dot product is
+	// below the cosine of half the threshold angle
+	{
+		const float scale = 0.9999995f;
+		const Pose shorter = { { a.orientation.x * scale, a.orientation.y * scale, a.orientation.z * scale, a.orientation.w * scale }, a.position };
+		TEST_CHECK(PoseWithinTolerance(a, shorter, maxDistance, maxAngle));
+		TEST_CHECK(PoseWithinTolerance(shorter, a, maxDistance, maxAngle));
+
+		const Pose rotated = TestPose(0, 1, 0, 0.7f + maxAngle * 1.1f, position);
+		const Pose rotatedShorter = { { rotated.orientation.x * scale, rotated.orientation.y * scale, rotated.orientation.z * scale, rotated.orientation.w * scale }, position };
+		TEST_CHECK(!PoseWithinTolerance(a, rotatedShorter, maxDistance, maxAngle));
+	}
+}
+
+
+////////////////////////////////////////////////
+// Frame pacing
+////////////////////////////////////////////////
+
+void TestFramePacing()
+{
+	FramePacing pacing;
+	pacing.interval = 2;
+	pacing.settleFrames = 3;
+
+	// Full rate while moving and while settling
+	TEST_CHECK(FramePacingShouldRender(pacing, true));
+	for (uint32_t i = 0; i < pacing.settleFrames; i++)
+	{
+		TEST_CHECK(FramePacingShouldRender(pacing, false));
+	}
+
+	// Then every other frame
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+	TEST_CHECK(FramePacingShouldRender(pacing, false));
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+	TEST_CHECK(FramePacingShouldRender(pacing, false));
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+
+	// Motion renders the frame it is seen in and settles again from the start
+	TEST_CHECK(FramePacingShouldRender(pacing, true));
+	for (uint32_t i = 0; i < pacing.settleFrames; i++)
+	{
+		TEST_CHECK(FramePacingShouldRender(pacing, false));
+	}
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+
+	// Reset starts over at full rate
+	FramePacingReset(pacing);
+	TEST_CHECK(pacing.stableFrameCount == 0 && pacing.skippedFrameCount == 0);
+	for (uint32_t i = 0; i < pacing.settleFrames; i++)
+	{
+		TEST_CHECK(FramePacingShouldRender(pacing, false));
+	}
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+
+	// Longer intervals skip interval - 1 frames per rendered one
+	pacing.interval = 3;
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+	TEST_CHECK(FramePacingShouldRender(pacing, false));
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+	TEST_CHECK(!FramePacingShouldRender(pacing, false));
+	TEST_CHECK(FramePacingShouldRender(pacing, false));
+
+	// Interval 1 always renders
+	{
+		FramePacing fullRate;
+		fullRate.interval = 1;
+		fullRate.settleFrames = 0;
+		for (uint32_t i = 0; i < 10; i++)
+		{
+			TEST_CHECK(FramePacingShouldRender(fullRate, false));
+		}
+	}
+}
+
+
+int main()
+{
+	TestPoseWithinTolerance();
+	TestFramePacing();
+
+	printf("%s, %u checks failed\n", testFailureCount == 0 ? "Passed" : "Failed", testFailureCount);
+	return testFailureCount == 0 ? 0 : 1;
+}
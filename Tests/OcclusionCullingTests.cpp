@@ -0,0 +1,154 @@
+#include <vector>
+#include <cstdio>
+
+#include "OcclusionCulling.h"
+#include "SoftwareRasterizer.h"
+#include "JobSystem.h"
+#include "CubeMesh.h"
+#include "Core/Scene.h"
+
+using namespace std;
+
+// Checks that occlusion culling is conservative: hidden cubes are culled, anything that could show a pixel is kept and
+// culling never changes the rendered image. Returns non-zero when a check failed.
+//
+//   OcclusionCullingTests
+
+
+uint32_t testFailureCount = 0;
+
+#define TEST_CHECK(condition) \
+	do { if (!(condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); testFailureCount++; } } while (0)
+
+
+////////////////////////////////////////////////
+// Single cubes
+////////////////////////////////////////////////
+
+// Cube of half size scale at a point straight ahead of the left test eye, x and y relative to the eye's axis
+Float4x4 TestCube(float x, float y, float z, float scale)
+{
+	const Pose pose = { { 0, 0, 0, 1 }, { sceneTestEyes[0].pose.position.x + x, y, z } };
+	return MatrixFromPose(pose, scale);
+}
+
+
+// Buffer with a single large occluder one meter ahead of the left eye
+void TestOccluderBuffer(OcclusionBuffer& buffer, const Float4x4& occluder)
+{
+	const uint32_t index = 0;
+	OcclusionBegin(buffer, SceneTestViewProjection(0));
+	OcclusionAddOccluderCandidates(buffer, &occluder, &index, 1);
+	OcclusionRasterizeOccluders(buffer, &occluder, 1);
+}
+
+
+void TestSingleCubes()
+{
+	const Float4x4 occluder = TestCube(0, 0, -1.0f, 0.3f);
+	OcclusionBuffer buffer;
+	TestOccluderBuffer(buffer, occluder);
+	TEST_CHECK(buffer.occluderCount == 1);
+
+	// The occluder itself is in front of its own depth
+	TEST_CHECK(OcclusionCubeVisible(buffer, occluder));
+
+	// Fully hidden behind the occluder
+	TEST_CHECK(!OcclusionCubeVisible(buffer, TestCube(0, 0, -3.0f, 0.05f)));
+	TEST_CHECK(!OcclusionCubeVisible(buffer, TestCube(0.4f, -0.4f, -3.0f, 0.05f)));
+
+	// Partly sticking out past the silhouette of the occluder's front face, which is 1.29 off axis at this distance
+	TEST_CHECK(OcclusionCubeVisible(buffer, TestCube(1.3f, 0, -3.0f, 0.1f)));
+	TEST_CHECK(OcclusionCubeVisible(buffer, TestCube(0, -1.3f, -3.0f, 0.1f)));
+
+	// In front of the occluder
+	TEST_CHECK(OcclusionCubeVisible(buffer, TestCube(0, 0, -0.5f, 0.05f)));
+
+	// Crossing the near plane, or behind the occluder's depth but off screen
+	TEST_CHECK(OcclusionCubeVisible(buffer, TestCube(0, 0, -sceneTestClipNear, 0.05f)));
+	TEST_CHECK(OcclusionCubeVisible(buffer, TestCube(20.0f, 0, -3.0f, 0.05f)));
+	TEST_CHECK(OcclusionCubeVisible(buffer, TestCube(0, 0, 3.0f, 0.05f)));
+}
+
+
+////////////////////////////////////////////////
+// Rendered images
+////////////////////////////////////////////////
+
+// The test scene rendered for both eyes with and without occlusion culling gives the same pixels
+void TestRenderedImages()
+{
+	vector<Float4x4> models;
+	for (const Pose& pose : SceneTestPoses(3000))
+	{
+		models.push_back(MatrixFromPose(pose, cubeScale));
+	}
+	const SoftwareMesh mesh = { cubeVertices, (uint32_t)(sizeof(cubeVertices) / cubeVertexStride), cubeIndices, cubeIndexCount };
+
+	SoftwareRasterizer rasterizer;
+	SoftwareRasterizerInitialize(rasterizer);
+
+	size_t occludedCount = 0;
+	for (size_t eye = 0; eye < sceneTestEyeCount; eye++)
+	{
+		const Float4x4 viewProjection = SceneTestViewProjection(eye);
+
+
+		// Every cube is an occluder candidate, the closest ones get rasterized
+		vector<Float4x4> unoccludedModels;
+		{
+			vector<uint32_t> indices(models.size());
+			for (uint32_t i = 0; i < (uint32_t)indices.size(); i++)
+			{
+				indices[i] = i;
+			}
+
+			OcclusionBuffer buffer;
+			OcclusionBegin(buffer, viewProjection);
+			OcclusionAddOccluderCandidates(buffer, models.data(), indices.data(), indices.size());
+			OcclusionRasterizeOccluders(buffer, models.data(), occlusionDefaultOccluderCount);
+
+			for (const Float4x4& model : models)
+			{
+				if (OcclusionCubeVisible(buffer, model))
+				{
+					unoccludedModels.push_back(model);
+				}
+			}
+			occludedCount += models.size() - unoccludedModels.size();
+		}
+
+
+		// Bit exact, the same rasterizer draws the same triangles either way
+		{
+			const float clear[] = { 0, 0, 0, 1 };
+			SoftwareRenderTarget all;
+			SoftwareRenderTarget unoccluded;
+			SoftwareCreateRenderTarget(all, 320, 208);
+			SoftwareCreateRenderTarget(unoccluded, 320, 208);
+			SoftwareClear(all, clear, 1.0f);
+			SoftwareClear(unoccluded, clear, 1.0f);
+			SoftwareDrawInstances(rasterizer, all, mesh, viewProjection, models);
+			SoftwareDrawInstances(rasterizer, unoccluded, mesh, viewProjection, unoccludedModels);
+
+			TEST_CHECK(all.color == unoccluded.color);
+		}
+	}
+
+	// Otherwise the comparison proves nothing
+	TEST_CHECK(occludedCount > 0);
+}
+
+
+int main()
+{
+	JobSystemInitialize(0);
+
+	TestSingleCubes();
+	TestRenderedImages();
+
+	JobSystemShutdown();
+
+	printf("%s, %u checks failed\n", testFailureCount == 0 ? "Passed" : "Failed", testFailureCount);
+	return testFailureCount == 0 ? 0 : 1;
+}